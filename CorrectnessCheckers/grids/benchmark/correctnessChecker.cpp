@@ -5,65 +5,80 @@
 #include <Structs/Graphs/dynamicGraph.h>
 #include <Structs/Graphs/adjacencyListImpl.h>
 #include <Algorithms/multicriteriaDijkstra.h>
+#include <Algorithms/multicriteriaSourceTree.h>
+#include <Algorithms/paretoQueueSearch.h>
+#include <Algorithms/parallelNamoaStar.h>
+#include <Algorithms/multicriteriaCH.h>
 #include <Algorithms/multicriteriaGraph.h>
 #include <Algorithms/namoaStar.h>
+#include <Algorithms/boaStar.h>
 #include <Algorithms/namoaStar2.h>
+#include <Algorithms/namoaStarDR.h>
 #include <Algorithms/multicriteriaArc.h>
+#include <Algorithms/twoPhaseSearch.h>
 #include <Heuristics/blind.h>
 #include <Heuristics/ideal.h>
 #include <Heuristics/boundedIdeal.h>
+#include <Heuristics/multiValued.h>
+#include <Heuristics/geometric.h>
 #include <Checkers/multiCriteriaChecker.h>
 #include <Checkers/multiCriteriaResults.h>
 #include <Checkers/Grids/multiCriteriaGridChecker.h>
 #include <Utilities/timer.h>
+#include <Utilities/batchExecutor.h>
 #include <Utilities/colormod.h>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
 
+static std::vector<double> EPSILON; // approximation factor of every criterion, empty for the exact algorithms
+
 template< class algorithmVariant, typename GraphType>
 void runQueries( GraphType& G, std::vector< std::pair<unsigned int,unsigned int> >& queries,
                  std::vector<typename GraphType::NodeDescriptor>& ids, GridChecker& gChecker, const unsigned int showOnScreen)
 {
-    typedef typename GraphType::NodeIterator NodeIterator;
-    NodeIterator s,t;
     unsigned int sourceId, targetId;
-    unsigned int timestamp = 0;
-    //create algorithm
-    algorithmVariant algorithm( G, NUM_CRITERIA, &timestamp);
+    //create one algorithm per worker
+    BatchExecutor<GraphType, algorithmVariant> executor( G, NUM_CRITERIA, NUM_WORKERS);
+    executor.forEachAlgorithm( []( algorithmVariant& algorithm) { algorithm.setEpsilon( EPSILON); });
+    if ( ( QUERY_LIMITS.maxTime > 0 || QUERY_LIMITS.maxLabels) && !( executor.setQueryLimits( QUERY_LIMITS)))
+    {
+        std::cout << "The algorithm has no query limits, they are ignored\n";
+    }
     //run queries
+    std::vector<BatchResult> results;
+    executor.run( queries, ids, results);
     unsigned int query_n = 0;
     double numLabels = 0;
     double totalTime = 0;
+    unsigned int numStopped = 0;
     for( std::vector< std::pair<unsigned int,unsigned int> >::iterator it = queries.begin();
          it != queries.end(); ++it)
     {
-        //clear nodes
-        NodeIterator u, lastnode;
-        for( u = G.beginNodes(), lastnode = G.endNodes(); u != lastnode; ++u)
-        {
-            u->g_op.clear();
-            u->g_cl.clear();
-        }
+        BatchResult& result = results[query_n];
         sourceId = it->first;
         targetId = it->second;
-        s = G.getNodeIterator( ids[sourceId]);
-        t = G.getNodeIterator( ids[targetId]);
-        Timer timer;
-        timer.start();
-        algorithm.init( s, t, NUM_CRITERIA);
-        auto heuristicTime = 1000 * timer.getElapsedTime();
-        timer.start();
-        algorithm.runQuery( s, t);
-        auto runtime = 1000 * timer.getElapsedTime();
+        auto heuristicTime = 1000 * result.heuristicTime;
+        auto runtime = 1000 * result.runtime;
         totalTime += runtime;
         // add Pareto efficient solutions to the results class
         MulticriteriaResults mResults( queries);
-        mResults.addResults( t->g_cl);
-        numLabels += algorithm.getGeneratedLabels();
+        mResults.addResults( result.solutions);
+        numLabels += result.generatedLabels;
         // Two things are checked: First, the set of solutions is the same; second, the solutions have been found in the same order.
+        // The solutions of a query stopped by its limits are only checked to be efficient, and the frontier to bound the missing ones.
         bool order = true;
-        bool correctness = mResults.checkParetoCosts( gChecker, query_n, order);
+        bool correctness;
+        if ( !( result.complete))
+        {
+            correctness = mResults.checkPartialCosts( gChecker, query_n, result.frontier, EPSILON);
+            ++numStopped;
+        }
+        else
+        {
+            correctness = EPSILON.empty() ? mResults.checkParetoCosts( gChecker, query_n, order) :
+                                            mResults.checkEpsilonCovering( gChecker, query_n, EPSILON);
+        }
         Color::Modifier def(Color::FG_DEFAULT);
         Color::Modifier red(Color::FG_RED);
         Color::Modifier green(Color::FG_GREEN);
@@ -79,16 +94,21 @@ void runQueries( GraphType& G, std::vector< std::pair<unsigned int,unsigned int>
             Color::Modifier lblue(Color::FG_LIGHT_BLUE);
             Color::Modifier cyan(Color::FG_CYAN);
             Color::Modifier lcyan(Color::FG_LIGHT_CYAN);
-            std::cout << blue << t->g_cl.size() << def << " efficient paths were found.\n";
-            std::cout << "\t\t\t" << lblue << algorithm.getGeneratedLabels() << def << " labels were scanned.\n";
+            std::cout << blue << result.solutions.size() << def << " efficient paths were found.\n";
+            std::cout << "\t\t\t" << lblue << result.generatedLabels << def << " labels were scanned.\n";
             std::cout << "\t\t\t" << cyan << heuristicTime << def << " msec. - calculation of heuristic.\n";
             std::cout << "\t\t\t" << lcyan << runtime << def << " msec. - algorithm runtime.\n";
+            if ( !( result.complete)) std::cout << "\t\t\t" << result.frontier.size() << " frontier bounds, the query was stopped by its limits.\n";
         }
         std::cout << "Solutions ... ->\t";
         if ( !( correctness))
         {
             std::cout << red << "Different!!!\n" << def;
-            t->printLabels( std::cout, G);
+            for ( std::vector<Label>::iterator label = result.solutions.begin(); label != result.solutions.end(); ++label)
+            {
+                label->print( std::cout, G);
+                std::cout << "\n";
+            }
             exit (EXIT_FAILURE);
         }
         else
@@ -104,6 +124,7 @@ void runQueries( GraphType& G, std::vector< std::pair<unsigned int,unsigned int>
     {
         std::cout << "\tAlgorithm Runtime:\t" << totalTime << " msec. ( " << (totalTime / queries.size()) << " msec. per query)\n";
         std::cout << "\tGenerated labels:\t " << numLabels << std::endl;
+        if ( numStopped) std::cout << "\tStopped by the limits:\t" << numStopped << " queries" << std::endl;
     }
 }
 
@@ -112,30 +133,126 @@ void runBenchmarks( GraphType& G, std::vector< std::pair<unsigned int,unsigned i
                     std::vector<typename GraphType::NodeDescriptor>& ids, GridChecker& gChecker,
                     const std::string& name, const unsigned int& algorithmVariant, const unsigned int showOnScreen)
 {
+    typedef GraphView<GraphType> ContextGraph;  // the algorithms run on the views of the workers (see BatchExecutor)
+    if ( ( 6 <= algorithmVariant) && ( algorithmVariant <= 8) && ( NUM_CRITERIA != 2))
+    {
+        std::cerr << "BOA* is only defined for the bicriteria benchmark\n";
+        return;
+    }
     switch( algorithmVariant)
     {
     case 1:
         // output message for all queries
         std::cout << "with NAMOA* (blind) ...\n\n";
-        runQueries<NamoaStar2<GraphType,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         break;
     case 2:
         std::cout << "with NAMOA*_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         break;
     case 3:
         std::cout << "with NAMOA*_bound_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
-        //std::cout << "with NAMOA* Arc Flags (" << name << ") ...\n\n";
-        //runQueries<NamoaStarArc<GraphType,GreatCircleHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 4:
+        std::cout << "with NAMOA*_multivalued ...\n\n";
+        runQueries<NamoaStar2<ContextGraph,MultiValuedHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 5:
+        std::cout << "with NAMOA*_geometric ...\n\n";
+        runQueries<NamoaStar2<ContextGraph,GeometricHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 6:
+        std::cout << "with BOA* (blind) ...\n\n";
+        runQueries<BOAStar<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 7:
+        std::cout << "with BOA*_tc ...\n\n";
+        runQueries<BOAStar<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 8:
+        std::cout << "with BOA*_bound_tc ...\n\n";
+        runQueries<BOAStar<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 9:
+        std::cout << "with NAMOA*dr (blind) ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 10:
+        std::cout << "with NAMOA*dr_tc ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 11:
+        std::cout << "with NAMOA*dr_bound_tc ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 12:
+        std::cout << "with multicriteria Dijkstra ...\n\n";
+        runQueries<MulticriteriaDijkstra<ContextGraph> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 13:
+        std::cout << "with multicriteria source tree ...\n\n";
+        runQueries<MulticriteriaSourceTree<ContextGraph> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 14:
+        std::cout << "with Pareto queue search (blind) ...\n\n";
+        runQueries<ParetoQueueSearch<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 15:
+        std::cout << "with Pareto queue search_tc ...\n\n";
+        runQueries<ParetoQueueSearch<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 16:
+        std::cout << "with parallel NAMOA* (blind) ...\n\n";
+        runQueries<ParallelNamoaStar<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 17:
+        std::cout << "with parallel NAMOA*_tc ...\n\n";
+        runQueries<ParallelNamoaStar<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 18:
+        std::cout << "with multicriteria contraction hierarchies ...\n\n";
+        runQueries<MulticriteriaCH<ContextGraph> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 19:
+        std::cout << "with NAMOA* arc flags (blind) ...\n\n";
+        runQueries<NamoaStarArc<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 20:
+        std::cout << "with NAMOA* arc flags_tc ...\n\n";
+        runQueries<NamoaStarArc<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 21:
+        std::cout << "with NAMOA* geometric containers (blind) ...\n\n";
+        runQueries<NamoaStarGC<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 22:
+        std::cout << "with NAMOA* geometric containers_tc ...\n\n";
+        runQueries<NamoaStarGC<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 23:
+        std::cout << "with NAMOA* supported solutions (blind) ...\n\n";
+        runQueries<NamoaStarSupported<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 24:
+        std::cout << "with NAMOA* supported solutions_tc ...\n\n";
+        runQueries<NamoaStarSupported<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 25:
+        std::cout << "with two-phase search (blind) ...\n\n";
+        runQueries<TwoPhaseSearch<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        break;
+    case 26:
+        std::cout << "with two-phase search_tc ...\n\n";
+        runQueries<TwoPhaseSearch<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         break;
     case 0: // default
         std::cout << "with NAMOA* (blind) ...\n\n";
-        runQueries<NamoaStar2<GraphType,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,BlindHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         std::cout << "with NAMOA*_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,TCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         std::cout << "with NAMOA*_bound_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, gChecker, showOnScreen);
         break;
     }
 }
@@ -161,8 +278,16 @@ int main( int argc, char* argv[])
     po::options_description desc("Allowed options");
     desc.add_options()
         ("benchmark,b", po::value< unsigned int>(), "Benchmark to run. Bicriteria[2],  Tri-criterion[3]. Default:2")
-        ("algorithm,a", po::value< unsigned int>(), "Multicriteria Heuristic. All[0], Blind[1], Ideal Point[2], Bounded Ideal point[3]. Default:0")
-        ("showOnScreen,s", po::value< unsigned int>(), "Display stats on screen. Yes[1], No[0]. Default:1");
+        ("algorithm,a", po::value< unsigned int>(), "Multicriteria Heuristic. All[0], Blind[1], Ideal Point[2], Bounded Ideal point[3], Multi-valued[4], Geometric[5], BOA* Blind[6], BOA* Ideal Point[7], BOA* Bounded Ideal point[8], NAMOA*dr Blind[9], NAMOA*dr Ideal Point[10], NAMOA*dr Bounded Ideal point[11], Multicriteria Dijkstra[12], Multicriteria source tree[13], Pareto queue Blind[14], Pareto queue Ideal Point[15], Parallel NAMOA* Blind[16], Parallel NAMOA* Ideal Point[17], Multicriteria CH[18], NAMOA* arc flags Blind[19], NAMOA* arc flags Ideal Point[20], NAMOA* geometric containers Blind[21], NAMOA* geometric containers Ideal Point[22], NAMOA* supported solutions Blind[23], NAMOA* supported solutions Ideal Point[24], Two-phase Blind[25], Two-phase Ideal Point[26]. Default:0")
+        ("showOnScreen,s", po::value< unsigned int>(), "Display stats on screen. Yes[1], No[0]. Default:1")
+        ("epsilon,e", po::value< std::vector<double> >()->multitoken(), "Approximation factor, one value for all the criteria or one per criterion. Default: exact")
+        ("threads,t", po::value< unsigned int>(), "Number of threads of the parallel algorithms. Default: number of cores")
+        ("arcflags,f", po::value< std::string>(), "Binary file caching the arc flags. Default: computed on every run")
+        ("ch,c", po::value< std::string>(), "Binary file caching the contraction hierarchy. Default: computed on every run")
+        ("containers,g", po::value< std::string>(), "Binary file caching the geometric containers. Default: computed on every run")
+        ("workers,w", po::value< unsigned int>(), "Number of queries run at the same time, each one with its own copy of the node data. Default:1")
+        ("deadline,d", po::value< double>(), "Time limit of every query in msec. A stopped query is checked against the bounds of its missing solutions. Only the NAMOA* variants stop early. Default: none")
+        ("max-labels,l", po::value< unsigned int>(), "Largest number of labels expanded by a query, with the same checks as the deadline. Default: none");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -184,6 +309,34 @@ int main( int argc, char* argv[])
     {
         showOnScreen = vm["showOnScreen"].as<unsigned int>();
     }
+    if (vm.count("threads"))
+    {
+        NUM_THREADS = vm["threads"].as<unsigned int>();
+    }
+    if (vm.count("arcflags"))
+    {
+        ARC_FLAGS_FILE = vm["arcflags"].as<std::string>();
+    }
+    if (vm.count("ch"))
+    {
+        CH_FILE = vm["ch"].as<std::string>();
+    }
+    if (vm.count("containers"))
+    {
+        GEOMETRIC_CONTAINERS_FILE = vm["containers"].as<std::string>();
+    }
+    if (vm.count("workers"))
+    {
+        NUM_WORKERS = vm["workers"].as<unsigned int>();
+    }
+    if (vm.count("deadline"))
+    {
+        QUERY_LIMITS.maxTime = vm["deadline"].as<double>() / 1000;
+    }
+    if (vm.count("max-labels"))
+    {
+        QUERY_LIMITS.maxLabels = vm["max-labels"].as<unsigned int>();
+    }
     unsigned int nqueries;
     if ( benchmarkVariant == 2)
     {
@@ -199,6 +352,16 @@ int main( int argc, char* argv[])
     {
         std::cerr << "BenchmarkVariant provided not implemented yet\n";
     }
+    if (vm.count("epsilon"))
+    {
+        EPSILON = vm["epsilon"].as< std::vector<double> >();
+        if ( EPSILON.size() == 1) EPSILON.assign( NUM_CRITERIA, EPSILON[0]);
+        if ( EPSILON.size() != NUM_CRITERIA)
+        {
+            std::cerr << "One approximation factor per criterion is expected\n";
+            return 1;
+        }
+    }
 
     for ( unsigned int grid_n = 0; grid_n < NGRIDS; ++grid_n)
     {
@@ -7,18 +7,31 @@
 #include <Heuristics/blind.h>
 #include <Heuristics/ideal.h>
 #include <Heuristics/boundedIdeal.h>
+#include <Heuristics/multiValued.h>
+#include <Heuristics/geometric.h>
 #include <Algorithms/multicriteriaDijkstra.h>
+#include <Algorithms/multicriteriaSourceTree.h>
+#include <Algorithms/paretoQueueSearch.h>
+#include <Algorithms/parallelNamoaStar.h>
+#include <Algorithms/multicriteriaCH.h>
 #include <Algorithms/multicriteriaGraph.h>
 #include <Algorithms/namoaStar2.h>
+#include <Algorithms/namoaStarDR.h>
 #include <Algorithms/namoaStar.h>
+#include <Algorithms/boaStar.h>
 #include <Algorithms/multicriteriaArc.h>
+#include <Algorithms/twoPhaseSearch.h>
 #include <Utilities/timer.h>
+#include <Utilities/batchExecutor.h>
 #include <boost/program_options.hpp>
 
 #define NUM_CRITERIA 2
 
 namespace po = boost::program_options;
 
+static std::vector<double> EPSILON; // approximation factor of every criterion, empty for the exact algorithms
+static std::string WEIGHT_CHANGES_FILE;  // edge changes applied after the preprocessing (empty: none)
+
 class Results
 {
 public:
@@ -57,54 +70,85 @@ private:
     const std::vector< std::pair<unsigned int, unsigned int> >& m_queries;
 };
 
+/**
+ * @brief Reads a file of edge changes, one per line as "source target criteria...", with the DIMACS ids of the nodes.
+ * The edges must be numbered (see numberEdges)
+ *
+ * @return False if the file cannot be read or a line does not give an edge of the graph
+ */
+template<typename GraphType>
+bool readWeightChanges( GraphType& G, const std::vector<typename GraphType::NodeDescriptor>& ids, const std::string& filename,
+                        std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+{
+    std::ifstream in( filename.c_str());
+    std::string line;
+    while ( std::getline( in, line))
+    {
+        std::stringstream data( line);
+        unsigned int source, target;
+        if ( !( data >> source >> target)) continue;
+        std::vector<CriteriaList::WeightType> criteria( NUM_CRITERIA);
+        for ( unsigned int j = 0; j < NUM_CRITERIA; ++j)
+        {
+            if ( !( data >> criteria[j])) return false;
+        }
+        if ( ( source >= ids.size()) || ( target >= ids.size()) || ( ids[source] == 0) || ( ids[target] == 0) ||
+             !( G.hasEdge( ids[source], ids[target])))
+        {
+            return false;
+        }
+        changes.push_back( std::make_pair( G.getEdgeIterator( ids[source], ids[target])->id, CriteriaList( criteria)));
+    }
+    return in.eof();
+}
+
 template< class DijkstraVariant, typename GraphType>
 void runQueries( GraphType& G, std::vector< std::pair<unsigned int,unsigned int> >& queries, std::vector<typename GraphType::NodeDescriptor>& ids, Results& results, const std::string& graphname, const std::string& algoname)
 {
     std::vector<double> times;
     std::vector<double> paths;
     std::vector<double> generatedLabels;
-    typedef typename GraphType::NodeIterator NodeIterator;
-    typename GraphType::NodeIterator s,t;  
-    unsigned int sourceId, targetId;
-    unsigned int timestamp = 0;
-    //create dijkstra
-    DijkstraVariant dijkstra(G, NUM_CRITERIA, &timestamp);
+    //create one algorithm per worker
+    BatchExecutor<GraphType, DijkstraVariant> executor( G, NUM_CRITERIA, NUM_WORKERS);
+    executor.forEachAlgorithm( []( DijkstraVariant& dijkstra) { dijkstra.setEpsilon( EPSILON); });
+    if ( ( QUERY_LIMITS.maxTime > 0 || QUERY_LIMITS.maxLabels) && !( executor.setQueryLimits( QUERY_LIMITS)))
+    {
+        std::cout << "The algorithm has no query limits, they are ignored\n";
+    }
+    if ( !( WEIGHT_CHANGES_FILE.empty()))
+    {
+        // the edges are numbered by the preprocessing
+        std::vector< std::pair<unsigned int, CriteriaList> > changes;
+        executor.preprocess();
+        if ( !( readWeightChanges( G, ids, WEIGHT_CHANGES_FILE, changes)))
+        {
+            std::cout << "Cannot read the edge changes of " << WEIGHT_CHANGES_FILE << "\n";
+        }
+        else if ( !( executor.updateWeights( changes)))
+        {
+            std::cout << "The algorithm cannot repair its preprocessing, the edge changes are ignored\n";
+        }
+    }
     //create output message
     std::string message("Experiments at ");
     message.append( graphname + " " + algoname);
     ProgressBar show_progress( queries.size(), message);
     std::cout << message << std::endl;
     //run queries
-    Timer timer; 
-    unsigned int query_n = 1;   
-    for( std::vector< std::pair<unsigned int,unsigned int> >::iterator it = queries.begin(); it != queries.end(); ++it)
+    std::vector<BatchResult> batchResults;
+    executor.run( queries, ids, batchResults);
+    for( unsigned int query_n = 0; query_n < queries.size(); ++query_n)
     {
-        //clear nodes
-        NodeIterator u, lastnode;
-        for( u = G.beginNodes(), lastnode = G.endNodes(); u != lastnode; ++u)
-        {
-            u->g_op.clear();
-            u->g_cl.clear();
-            u->labels.clear();
-        }
-        sourceId = it->first;
-        targetId = it->second;
-        std::cout << query_n << ") " << sourceId << "->" << targetId << std::endl;
-        ++query_n;
-        s = G.getNodeIterator( ids[sourceId]);
-        t = G.getNodeIterator( ids[targetId]);
-		std::cout << "Initializing...\n";
-		timer.start();
-        dijkstra.init( s, t, NUM_CRITERIA);
-		std::cout << "Running query:\n";	
-        dijkstra.runQuery( s, t);
-        times.push_back(timer.getElapsedTime());
-        paths.push_back(t->g_cl.size());
-        //paths.push_back(t->labels.size());
-        generatedLabels.push_back(dijkstra.getGeneratedLabels());
+        const BatchResult& result = batchResults[query_n];
+        std::cout << query_n + 1 << ") " << queries[query_n].first << "->" << queries[query_n].second << std::endl;
+        times.push_back( result.heuristicTime + result.runtime);
+        paths.push_back( result.solutions.size());
+        generatedLabels.push_back( result.generatedLabels);
         std::cout << "\tTime:\t" << times[times.size()-1] << "sec\n";
-        std::cout << "\tNon-dominated solutions:\t" << t->g_cl.size() << "\n";
-		std::cout << "\tGenerated labels: " << dijkstra.getGeneratedLabels() << "\n\n";
+        std::cout << "\tNon-dominated solutions:\t" << result.solutions.size() << "\n";
+        std::cout << "\tGenerated labels: " << result.generatedLabels << "\n";
+        if ( !( result.complete)) std::cout << "\tStopped by the limits, " << result.frontier.size() << " frontier bounds\n";
+        std::cout << "\n";
     }
     results.add(graphname + " " + algoname,times);
     results.add(graphname + " " + algoname,generatedLabels);
@@ -114,30 +158,121 @@ void runQueries( GraphType& G, std::vector< std::pair<unsigned int,unsigned int>
 template< typename GraphType>
 void runExperimentsAt( GraphType& G, std::vector< std::pair<unsigned int,unsigned int> >& queries, std::vector<typename GraphType::NodeDescriptor>& ids, Results& results, const std::string& name, const unsigned int& algorithmVariant)
 {
+    typedef GraphView<GraphType> ContextGraph;  // the algorithms run on the views of the workers (see BatchExecutor)
     switch( algorithmVariant)
     {
     case 1:
         // output message for all queries
         std::cout << "with NAMOA* (blind) ...\n\n";
-        runQueries<NamoaStar2<GraphType,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*2_Blind");
+        runQueries<NamoaStar2<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*2_Blind");
         break;
     case 2:
         std::cout << "with NAMOA*_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_TC");
+        runQueries<NamoaStar2<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_TC");
         break;
     case 3:
         std::cout << "with NAMOA*_bound_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,BoundedTCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_BTC");
-        //std::cout << "with NAMOA* Arc Flags (" << name << ") ...\n\n";
-        //runQueries<NamoaStarArc<GraphType,GreatCircleHeuristic> >( G, queries, ids, gChecker, showOnScreen);
+        runQueries<NamoaStar2<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_BTC");
+        break;
+    case 4:
+        std::cout << "with NAMOA*_multivalued ...\n\n";
+        runQueries<NamoaStar2<ContextGraph,MultiValuedHeuristic> >( G, queries, ids, results, name, "NAMOA*2_MV");
+        break;
+    case 5:
+        std::cout << "with NAMOA*_geometric ...\n\n";
+        runQueries<NamoaStar2<ContextGraph,GeometricHeuristic> >( G, queries, ids, results, name, "NAMOA*2_GEO");
+        break;
+    case 6:
+        std::cout << "with BOA* (blind) ...\n\n";
+        runQueries<BOAStar<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "BOA*_Blind");
+        break;
+    case 7:
+        std::cout << "with BOA*_tc ...\n\n";
+        runQueries<BOAStar<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "BOA*_TC");
+        break;
+    case 8:
+        std::cout << "with BOA*_bound_tc ...\n\n";
+        runQueries<BOAStar<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, results, name, "BOA*_BTC");
+        break;
+    case 9:
+        std::cout << "with NAMOA*dr (blind) ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*dr_Blind");
+        break;
+    case 10:
+        std::cout << "with NAMOA*dr_tc ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*dr_TC");
+        break;
+    case 11:
+        std::cout << "with NAMOA*dr_bound_tc ...\n\n";
+        runQueries<NamoaStarDR<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, results, name, "NAMOA*dr_BTC");
+        break;
+    case 12:
+        std::cout << "with multicriteria Dijkstra ...\n\n";
+        runQueries<MulticriteriaDijkstra<ContextGraph> >( G, queries, ids, results, name, "MC_Dijkstra");
+        break;
+    case 13:
+        std::cout << "with multicriteria source tree ...\n\n";
+        runQueries<MulticriteriaSourceTree<ContextGraph> >( G, queries, ids, results, name, "MC_SourceTree");
+        break;
+    case 14:
+        std::cout << "with Pareto queue search (blind) ...\n\n";
+        runQueries<ParetoQueueSearch<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "PQS_Blind");
+        break;
+    case 15:
+        std::cout << "with Pareto queue search_tc ...\n\n";
+        runQueries<ParetoQueueSearch<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "PQS_TC");
+        break;
+    case 16:
+        std::cout << "with parallel NAMOA* (blind) ...\n\n";
+        runQueries<ParallelNamoaStar<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "PNAMOA*_Blind");
+        break;
+    case 17:
+        std::cout << "with parallel NAMOA*_tc ...\n\n";
+        runQueries<ParallelNamoaStar<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "PNAMOA*_TC");
+        break;
+    case 18:
+        std::cout << "with multicriteria contraction hierarchies ...\n\n";
+        runQueries<MulticriteriaCH<ContextGraph> >( G, queries, ids, results, name, "MCH");
+        break;
+    case 19:
+        std::cout << "with NAMOA* arc flags (blind) ...\n\n";
+        runQueries<NamoaStarArc<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*Arc_Blind");
+        break;
+    case 20:
+        std::cout << "with NAMOA* arc flags_tc ...\n\n";
+        runQueries<NamoaStarArc<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*Arc_TC");
+        break;
+    case 21:
+        std::cout << "with NAMOA* geometric containers (blind) ...\n\n";
+        runQueries<NamoaStarGC<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*GC_Blind");
+        break;
+    case 22:
+        std::cout << "with NAMOA* geometric containers_tc ...\n\n";
+        runQueries<NamoaStarGC<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*GC_TC");
+        break;
+    case 23:
+        std::cout << "with NAMOA* supported solutions (blind) ...\n\n";
+        runQueries<NamoaStarSupported<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*Supported_Blind");
+        break;
+    case 24:
+        std::cout << "with NAMOA* supported solutions_tc ...\n\n";
+        runQueries<NamoaStarSupported<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*Supported_TC");
+        break;
+    case 25:
+        std::cout << "with two-phase search (blind) ...\n\n";
+        runQueries<TwoPhaseSearch<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "TwoPhase_Blind");
+        break;
+    case 26:
+        std::cout << "with two-phase search_tc ...\n\n";
+        runQueries<TwoPhaseSearch<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "TwoPhase_TC");
         break;
     case 0: // default
         std::cout << "with NAMOA* (blind) ...\n\n";
-        runQueries<NamoaStar2<GraphType,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*2_Blind");
+        runQueries<NamoaStar2<ContextGraph,BlindHeuristic> >( G, queries, ids, results, name, "NAMOA*2_Blind");
         std::cout << "with NAMOA*_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_TC");
+        runQueries<NamoaStar2<ContextGraph,TCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_TC");
         std::cout << "with NAMOA*_bound_tc ...\n\n";
-        runQueries<NamoaStar2<GraphType,BoundedTCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_BTC");
+        runQueries<NamoaStar2<ContextGraph,BoundedTCHeuristic> >( G, queries, ids, results, name, "NAMOA*2_BTC");
         break;
     }
 }
@@ -186,8 +321,17 @@ int main( int argc, char* argv[])
     po::options_description desc("Allowed options");
     desc.add_options()
         ("size,s", po::value< unsigned int>(), "number of queries. Default:50")
-        ("algorithm,a", po::value< unsigned int>(), "NAMOA* algorithm. All[0], NAMOA* blind[1], NAMOA* TC[2], NAMOA* Bounded TC[3]. Default:0")
-        ("map,m", po::value< std::string>(), "Input map. The name of the map to read. Maps must be in '$HOME/Projects/Graphs/DIMACS9/");
+        ("algorithm,a", po::value< unsigned int>(), "NAMOA* algorithm. All[0], NAMOA* blind[1], NAMOA* TC[2], NAMOA* Bounded TC[3], NAMOA* Multi-valued[4], NAMOA* Geometric[5], BOA* blind[6], BOA* TC[7], BOA* Bounded TC[8], NAMOA*dr blind[9], NAMOA*dr TC[10], NAMOA*dr Bounded TC[11], Multicriteria Dijkstra[12], Multicriteria source tree[13], Pareto queue Blind[14], Pareto queue Ideal Point[15], Parallel NAMOA* Blind[16], Parallel NAMOA* Ideal Point[17], Multicriteria CH[18], NAMOA* arc flags Blind[19], NAMOA* arc flags Ideal Point[20], NAMOA* geometric containers Blind[21], NAMOA* geometric containers Ideal Point[22], NAMOA* supported solutions Blind[23], NAMOA* supported solutions Ideal Point[24], Two-phase Blind[25], Two-phase Ideal Point[26]. Default:0")
+        ("map,m", po::value< std::string>(), "Input map. The name of the map to read. Maps must be in '$HOME/Projects/Graphs/DIMACS9/")
+        ("epsilon,e", po::value< std::vector<double> >()->multitoken(), "Approximation factor, one value for all the criteria or one per criterion. Default: exact")
+        ("threads,t", po::value< unsigned int>(), "Number of threads of the parallel algorithms. Default: number of cores")
+        ("arcflags,f", po::value< std::string>(), "Binary file caching the arc flags. Default: computed on every run")
+        ("ch,c", po::value< std::string>(), "Binary file caching the contraction hierarchy. Default: computed on every run")
+        ("containers,g", po::value< std::string>(), "Binary file caching the geometric containers. Default: computed on every run")
+        ("workers,w", po::value< unsigned int>(), "Number of queries run at the same time, each one with its own copy of the node data. Default:1")
+        ("deadline,d", po::value< double>(), "Time limit of every query in msec. A stopped query keeps the solutions found so far. Only the NAMOA* variants stop early. Default: none")
+        ("max-labels,l", po::value< unsigned int>(), "Largest number of labels expanded by a query. Default: none")
+        ("updates,u", po::value< std::string>(), "File of edge changes, one per line as 'source target distance time', applied to the graph after the preprocessing, which is repaired. Only NAMOA* arc flags[19,20] supports them, and they stay for the algorithms run next. Default: none");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);    
@@ -198,6 +342,21 @@ int main( int argc, char* argv[])
     if (vm.count("size"))       numQueries = vm["size"].as<unsigned int>();
     if (vm.count("algorithm"))  algorithmVariant = vm["algorithm"].as<unsigned int>();
     if (vm.count("map"))        map = vm["map"].as<std::string>();
+    if (vm.count("threads"))    NUM_THREADS = vm["threads"].as<unsigned int>();
+    if (vm.count("arcflags"))   ARC_FLAGS_FILE = vm["arcflags"].as<std::string>();
+    if (vm.count("ch"))         CH_FILE = vm["ch"].as<std::string>();
+    if (vm.count("containers")) GEOMETRIC_CONTAINERS_FILE = vm["containers"].as<std::string>();
+    if (vm.count("workers"))    NUM_WORKERS = vm["workers"].as<unsigned int>();
+    if (vm.count("deadline"))   QUERY_LIMITS.maxTime = vm["deadline"].as<double>() / 1000;
+    if (vm.count("max-labels")) QUERY_LIMITS.maxLabels = vm["max-labels"].as<unsigned int>();
+    if (vm.count("updates"))    WEIGHT_CHANGES_FILE = vm["updates"].as<std::string>();
+    if (vm.count("epsilon"))    EPSILON = vm["epsilon"].as< std::vector<double> >();
+    if (EPSILON.size() == 1)    EPSILON.assign( NUM_CRITERIA, EPSILON[0]);
+    if (!EPSILON.empty() && EPSILON.size() != NUM_CRITERIA)
+    {
+        std::cerr << "One approximation factor per criterion is expected\n";
+        return 1;
+    }
     Graph G;
     DIMACS9DoubleReader<Graph> reader( basePath + map + "/" + map + "_dist.gr",
                                 basePath + map + "/" + map + "_travel.gr", basePath + map + "/" + map + ".co");
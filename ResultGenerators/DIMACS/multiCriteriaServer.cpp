@@ -0,0 +1,482 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/adjacencyListImpl.h>
+#include <Heuristics/blind.h>
+#include <Heuristics/ideal.h>
+#include <Heuristics/boundedIdeal.h>
+#include <Algorithms/multicriteriaDijkstra.h>
+#include <Algorithms/multicriteriaCH.h>
+#include <Algorithms/multicriteriaGraph.h>
+#include <Algorithms/namoaStar2.h>
+#include <Algorithms/namoaStarDR.h>
+#include <Algorithms/boaStar.h>
+#include <Algorithms/multicriteriaArc.h>
+#include <Algorithms/sharedNamoaStar.h>
+#include <Structs/Graphs/sharedGraph.h>
+#include <Utilities/timer.h>
+#include <Utilities/batchExecutor.h>
+#include <Utilities/snapshotHandle.h>
+#include <boost/program_options.hpp>
+
+#define NUM_CRITERIA 2
+
+namespace po = boost::program_options;
+
+static std::vector<double> EPSILON; // approximation factor of every criterion, empty for the exact algorithms
+
+/**
+ * @class Connection
+ *
+ * @brief Line oriented input and output of the server, either stdin and stdout or a connected socket
+ */
+class Connection
+{
+public:
+    Connection( int in, int out): m_in(in), m_out(out), m_begin(0), m_end(0), m_closed(false)
+    {
+    }
+
+    bool readLine( std::string& line)
+    {
+        line.clear();
+        while ( true)
+        {
+            if ( ( m_begin == m_end) && !( fill())) return !( line.empty());
+            char c = m_buffer[m_begin++];
+            if ( c == '\n') return true;
+            if ( c != '\r') line.push_back( c);
+        }
+    }
+
+    /**
+     * @brief Checks whether readLine returns without waiting for input. The input already sent is buffered, so a
+     * line is only reported once it is complete
+     */
+    bool hasLine()
+    {
+        while ( !( memchr( m_buffer + m_begin, '\n', m_end - m_begin)))
+        {
+            if ( m_end - m_begin == sizeof( m_buffer)) return true;
+            pollfd status;
+            status.fd = m_in;
+            status.events = POLLIN;
+            if ( poll( &status, 1, 0) <= 0) return false;
+            if ( !( fill())) return true;
+        }
+        return true;
+    }
+
+    void write( const std::string& text)
+    {
+        for ( size_t done = 0; done < text.size(); )
+        {
+            ssize_t n = ::write( m_out, text.data() + done, text.size() - done);
+            if ( n <= 0) return;
+            done += n;
+        }
+    }
+
+private:
+    int m_in, m_out;
+    char m_buffer[4096];
+    unsigned int m_begin, m_end;
+    bool m_closed;
+
+    /**
+     * @brief Appends the next input to the buffer, after the characters not read yet
+     *
+     * @return False at the end of the input
+     */
+    bool fill()
+    {
+        if ( m_closed) return false;
+        memmove( m_buffer, m_buffer + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+        ssize_t n = ::read( m_in, m_buffer + m_end, sizeof( m_buffer) - m_end);
+        if ( n <= 0)
+        {
+            m_closed = true;
+            return false;
+        }
+        m_end += n;
+        return true;
+    }
+};
+
+typedef std::function<bool( std::pair<unsigned int,unsigned int>&)> NextQuery;
+typedef std::function<void( unsigned int, const std::pair<unsigned int,unsigned int>&, const BatchResult&)> ReportQuery;
+typedef std::function<void( const NextQuery&, const NextQuery&, const ReportQuery&)> QueryRunner;
+
+/**
+ * @brief Answers the queries of a connection until it is closed or a line reads "quit"
+ *
+ * Every line holds a query "source target", given as in the query files. The answer starts with the line
+ * "position source target numSolutions latency", where position is the number of the query in the connection and the
+ * latency is in msec., followed by one line per Pareto efficient solution with its cost vector. A query stopped by its
+ * limits (see QueryLimits) appends "incomplete numBounds" to the first line, and its solution lines are followed by
+ * numBounds lines with the lower bounds of the missing solutions: every efficient cost not sent is bounded by one of
+ * them. The answers are sent as soon as their queries are done, so with several workers they may come out of order. A line "reload" calls reload,
+ * if the server supports it, and is not answered.
+ *
+ * A query runner gets the function giving the next query, the same function returning false instead of waiting when no
+ * query is available yet, and the function reporting the results (see BatchExecutor::serve). Both functions must be
+ * called by one worker at a time.
+ */
+bool serveConnection( const QueryRunner& runQueries, const std::function<bool( unsigned int)>& isNode,
+                      const std::function<void()>& reload, Connection& connection)
+{
+    std::mutex output;
+    bool quit = false;
+    unsigned int numQueries = 0;
+    double totalLatency = 0;
+    auto readQuery = [&]( std::pair<unsigned int,unsigned int>& query, const bool& wait)
+    {
+        std::string line;
+        if ( quit) return false;
+        while ( ( wait || connection.hasLine()) && connection.readLine( line))
+        {
+            if ( line == "quit")
+            {
+                quit = true;
+                return false;
+            }
+            if ( ( line == "reload") && reload)
+            {
+                reload();
+                continue;
+            }
+            std::stringstream data( line);
+            if ( ( data >> query.first >> query.second) && isNode( query.first) && isNode( query.second))
+            {
+                return true;
+            }
+            if ( line.empty()) continue;
+            std::unique_lock<std::mutex> lock( output);
+            connection.write( "error " + line + "\n");
+        }
+        return false;
+    };
+    runQueries( [&]( std::pair<unsigned int,unsigned int>& query)
+    {
+        return readQuery( query, true);
+    }, [&]( std::pair<unsigned int,unsigned int>& query)
+    {
+        return readQuery( query, false);
+    }, [&]( unsigned int position, const std::pair<unsigned int,unsigned int>& query, const BatchResult& result)
+    {
+        double latency = 1000 * ( result.heuristicTime + result.runtime);
+        std::stringstream answer;
+        answer << position << " " << query.first << " " << query.second << " " << result.solutions.size() << " " << latency;
+        if ( !( result.complete)) answer << " incomplete " << result.frontier.size();
+        answer << "\n";
+        std::vector<CriteriaList> costs;
+        for ( unsigned int i = 0; i < result.solutions.size(); ++i)
+        {
+            costs.push_back( result.solutions[i].getCriteriaList());
+        }
+        costs.insert( costs.end(), result.frontier.begin(), result.frontier.end());
+        for ( unsigned int i = 0; i < costs.size(); ++i)
+        {
+            for ( unsigned int j = 0; j < costs[i].size(); ++j)
+            {
+                answer << ( j ? " " : "") << costs[i][j];
+            }
+            answer << "\n";
+        }
+        std::unique_lock<std::mutex> lock( output);
+        connection.write( answer.str());
+        ++numQueries;
+        totalLatency += latency;
+    });
+    std::cerr << numQueries << " queries answered, " << ( numQueries ? totalLatency / numQueries : 0) << " msec. per query\n";
+    return !quit;
+}
+
+/**
+ * @brief Answers the queries from stdin, or from the connections to a Unix-domain socket one after the other
+ */
+void acceptQueries( const QueryRunner& runQueries, const std::function<bool( unsigned int)>& isNode,
+                    const std::function<void()>& reload, const std::string& socketPath)
+{
+    if ( socketPath.empty())
+    {
+        Connection connection( STDIN_FILENO, STDOUT_FILENO);
+        serveConnection( runQueries, isNode, reload, connection);
+        return;
+    }
+    int server = socket( AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    memset( &address, 0, sizeof( address));
+    address.sun_family = AF_UNIX;
+    strncpy( address.sun_path, socketPath.c_str(), sizeof( address.sun_path) - 1);
+    unlink( socketPath.c_str());
+    if ( ( server < 0) || ( bind( server, (sockaddr*) &address, sizeof( address)) != 0) || ( listen( server, 16) != 0))
+    {
+        std::cerr << "Cannot listen on " << socketPath << "\n";
+        return;
+    }
+    // connections are answered one after the other, the queries of a connection by all the workers
+    bool running = true;
+    while ( running)
+    {
+        int client = accept( server, 0, 0);
+        if ( client < 0) continue;
+        Connection connection( client, client);
+        running = serveConnection( runQueries, isNode, reload, connection);
+        close( client);
+    }
+    close( server);
+    unlink( socketPath.c_str());
+}
+
+template< class AlgorithmType, typename GraphType>
+void serve( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& ids, const std::string& socketPath)
+{
+    BatchExecutor<GraphType, AlgorithmType> executor( G, NUM_CRITERIA, NUM_WORKERS);
+    executor.forEachAlgorithm( []( AlgorithmType& algorithm) { algorithm.setEpsilon( EPSILON); });
+    if ( ( QUERY_LIMITS.maxTime > 0 || QUERY_LIMITS.maxLabels) && !( executor.setQueryLimits( QUERY_LIMITS)))
+    {
+        std::cerr << "The algorithm has no query limits, they are ignored\n";
+    }
+    // the preprocessing is built or loaded once, before any query, and shared by all the workers
+    executor.preprocess();
+    std::cerr << "Ready, " << executor.getNumWorkers() << " workers\n";
+    acceptQueries( [&]( const NextQuery& next, const NextQuery&, const ReportQuery& report)
+    {
+        executor.serve( next, ids, report);
+    }, [&]( unsigned int id)
+    {
+        return ( id < ids.size()) && ( ids[id] != 0);
+    }, std::function<void()>(), socketPath);
+}
+
+/**
+ * @brief A graph attached from shared memory, with the searches of every worker
+ */
+struct SharedSnapshot
+{
+    SharedGraph graph;
+    std::vector< std::unique_ptr<InterleavedNamoaStar> > searches;
+};
+
+std::shared_ptr<const SharedSnapshot> loadSnapshot( const std::string& segment, const unsigned int& numWorkers,
+                                                    const unsigned int& numSlots)
+{
+    std::shared_ptr<SharedSnapshot> snapshot( new SharedSnapshot());
+    if ( !( snapshot->graph.attach( segment)))
+    {
+        std::cerr << "Cannot attach to " << segment << "\n";
+        return std::shared_ptr<const SharedSnapshot>();
+    }
+    for ( unsigned int i = 0; i < numWorkers; ++i)
+    {
+        snapshot->searches.push_back( std::unique_ptr<InterleavedNamoaStar>( new InterleavedNamoaStar( snapshot->graph, numSlots)));
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Answers the queries with SharedNamoaStar on a graph attached from shared memory. Every worker runs up to
+ * numSlots queries at once, interleaving their steps (see InterleavedNamoaStar)
+ *
+ * A "reload" attaches the segment again in the background, e.g. after a publisher replaced it with new weights, and
+ * swaps the new snapshot in. The queries already running finish on the previous one, which is unmapped afterwards.
+ */
+void serveShared( const std::string& segment, const unsigned int& numSlots, const std::string& socketPath)
+{
+    if ( QUERY_LIMITS.maxTime > 0 || QUERY_LIMITS.maxLabels)
+    {
+        std::cerr << "The searches on the shared-memory segment have no query limits, they are ignored\n";
+    }
+    ThreadPool pool( NUM_WORKERS);
+    SnapshotHandle<SharedSnapshot> handle;
+    std::shared_ptr<const SharedSnapshot> first = loadSnapshot( segment, pool.size(), numSlots);
+    if ( !first) return;
+    handle.publish( first);
+    std::cerr << "Ready, " << pool.size() << " workers, " << first->searches[0]->getNumSlots() << " queries per worker\n";
+    first.reset();
+    acceptQueries( [&]( const NextQuery& next, const NextQuery& tryNext, const ReportQuery& report)
+    {
+        std::mutex input, output;
+        unsigned int count = 0;
+        pool.run( [&]( unsigned int worker)
+        {
+            bool isOutdated = true;
+            while ( isOutdated)
+            {
+                // a new snapshot is only used by the queries started after it is published
+                unsigned int version = handle.getVersion();
+                std::shared_ptr<const SharedSnapshot> snapshot = handle.acquire();
+                isOutdated = false;
+                auto assign = [&]( InterleavedNamoaStar::Slot& slot, const NextQuery& source)
+                {
+                    isOutdated = ( handle.getVersion() != version);
+                    if ( isOutdated || !( source( slot.query))) return false;
+                    slot.position = count++;
+                    return true;
+                };
+                snapshot->searches[worker]->run( [&]( InterleavedNamoaStar::Slot& slot)
+                {
+                    std::unique_lock<std::mutex> lock( input);
+                    return assign( slot, next);
+                }, [&]( InterleavedNamoaStar::Slot& slot)
+                {
+                    // the worker has queries running, so it waits neither for the input nor for a worker reading it
+                    std::unique_lock<std::mutex> lock( input, std::try_to_lock);
+                    return lock.owns_lock() && assign( slot, tryNext);
+                }, [&]( InterleavedNamoaStar::Slot& slot)
+                {
+                    BatchResult result;
+                    result.runtime = slot.timer.getElapsedTime();
+                    result.generatedLabels = slot.search->getGeneratedLabels();
+                    const std::vector<CriteriaList>& solutions = slot.search->getSolutions();
+                    for ( unsigned int i = 0; i < solutions.size(); ++i)
+                    {
+                        result.solutions.push_back( Label( solutions[i], 0, 0));
+                    }
+                    std::unique_lock<std::mutex> lock( output);
+                    report( slot.position, slot.query, result);
+                });
+            }
+        });
+    }, [&]( unsigned int id)
+    {
+        // ids without a node (id 0 in DIMACS) have no edges
+        std::shared_ptr<const SharedSnapshot> snapshot = handle.acquire();
+        const SharedGraph& graph = snapshot->graph;
+        return ( id < graph.getNumNodes()) && ( graph.beginEdges( id) != graph.endEdges( id) || graph.beginInEdges( id) != graph.endInEdges( id));
+    }, [&]()
+    {
+        handle.reload( [&]()
+        {
+            std::shared_ptr<const SharedSnapshot> snapshot = loadSnapshot( segment, pool.size(), numSlots);
+            if ( snapshot) std::cerr << "Snapshot " << handle.getVersion() + 1 << " of " << segment << " loaded\n";
+            return snapshot;
+        });
+    }, socketPath);
+    handle.wait();
+}
+
+template< typename GraphType>
+void serveWith( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& ids, const unsigned int& algorithmVariant, const std::string& socketPath)
+{
+    typedef GraphView<GraphType> ContextGraph;  // the algorithms run on the views of the workers (see BatchExecutor)
+    switch( algorithmVariant)
+    {
+    case 1:
+        serve<NamoaStar2<ContextGraph,BlindHeuristic> >( G, ids, socketPath);
+        break;
+    case 7:
+        serve<BOAStar<ContextGraph,TCHeuristic> >( G, ids, socketPath);
+        break;
+    case 10:
+        serve<NamoaStarDR<ContextGraph,TCHeuristic> >( G, ids, socketPath);
+        break;
+    case 12:
+        serve<MulticriteriaDijkstra<ContextGraph> >( G, ids, socketPath);
+        break;
+    case 18:
+        serve<MulticriteriaCH<ContextGraph> >( G, ids, socketPath);
+        break;
+    case 20:
+        serve<NamoaStarArc<ContextGraph,TCHeuristic> >( G, ids, socketPath);
+        break;
+    case 2:
+    default:
+        serve<NamoaStar2<ContextGraph,TCHeuristic> >( G, ids, socketPath);
+        break;
+    }
+}
+
+typedef DynamicGraph< AdjacencyListImpl, Node, Edge>       Graph;
+
+int main( int argc, char* argv[])
+{
+    std::string basePath = std::string(getenv("HOME")) + "/Projects/Graphs/DIMACS9/";
+    // Set default parameters
+    unsigned int algorithmVariant = 2;
+    std::string map ="NY";
+    std::string socketPath;
+    std::string segment;
+    unsigned int numSlots = 1;
+    // Declare the supported options.
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("algorithm,a", po::value< unsigned int>(), "Algorithm, numbered as in multiCriteriaDimacs9. NAMOA* blind[1], NAMOA* TC[2], BOA* TC[7], NAMOA*dr TC[10], Multicriteria Dijkstra[12], Multicriteria CH[18], NAMOA* arc flags Ideal Point[20]. Default:2")
+        ("map,m", po::value< std::string>(), "Input map. The name of the map to read. Maps must be in '$HOME/Projects/Graphs/DIMACS9/")
+        ("socket,u", po::value< std::string>(), "Unix-domain socket to listen on. Default: queries from stdin, answers to stdout")
+        ("epsilon,e", po::value< std::vector<double> >()->multitoken(), "Approximation factor, one value for all the criteria or one per criterion. Default: exact")
+        ("threads,t", po::value< unsigned int>(), "Number of threads of the parallel algorithms. Default: number of cores")
+        ("arcflags,f", po::value< std::string>(), "Binary file caching the arc flags. Default: computed at start-up")
+        ("ch,c", po::value< std::string>(), "Binary file caching the contraction hierarchy. Default: computed at start-up")
+        ("workers,w", po::value< unsigned int>(), "Number of queries run at the same time, each one with its own copy of the node data. Default:1")
+        ("shared,x", po::value< std::string>(), "POSIX shared-memory segment holding the graph, e.g. /NY. It is attached if it exists, otherwise the map is read and written to it. The queries are answered by NAMOA* TC on the segment")
+        ("deadline,d", po::value< double>(), "Time limit of every query in msec. A stopped query is answered with the solutions found so far and the bounds of the missing ones. Only NAMOA*[1,2] stops early. Default: none")
+        ("max-labels,l", po::value< unsigned int>(), "Largest number of labels expanded by a query, answered as with the deadline. Default: none")
+        ("interleave,i", po::value< unsigned int>(), "Number of queries run by every worker at once on the shared-memory segment, switching query after every step to hide memory latency. Default:1")
+        ("publish,p", "Read the map, replace the shared-memory segment with it and exit. The servers attached to the segment switch to it on 'reload'");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("algorithm"))  algorithmVariant = vm["algorithm"].as<unsigned int>();
+    if (vm.count("map"))        map = vm["map"].as<std::string>();
+    if (vm.count("socket"))     socketPath = vm["socket"].as<std::string>();
+    if (vm.count("threads"))    NUM_THREADS = vm["threads"].as<unsigned int>();
+    if (vm.count("arcflags"))   ARC_FLAGS_FILE = vm["arcflags"].as<std::string>();
+    if (vm.count("ch"))         CH_FILE = vm["ch"].as<std::string>();
+    if (vm.count("workers"))    NUM_WORKERS = vm["workers"].as<unsigned int>();
+    if (vm.count("shared"))     segment = vm["shared"].as<std::string>();
+    if (vm.count("interleave")) numSlots = vm["interleave"].as<unsigned int>();
+    if (vm.count("deadline"))   QUERY_LIMITS.maxTime = vm["deadline"].as<double>() / 1000;
+    if (vm.count("max-labels")) QUERY_LIMITS.maxLabels = vm["max-labels"].as<unsigned int>();
+    bool publish = vm.count("publish") && !( segment.empty());
+    if (vm.count("epsilon"))    EPSILON = vm["epsilon"].as< std::vector<double> >();
+    if (EPSILON.size() == 1)    EPSILON.assign( NUM_CRITERIA, EPSILON[0]);
+    if (!EPSILON.empty() && EPSILON.size() != NUM_CRITERIA)
+    {
+        std::cerr << "One approximation factor per criterion is expected\n";
+        return 1;
+    }
+    // the answers are the only output on stdout, the messages of the reader and the algorithms go to stderr
+    std::cout.rdbuf( std::cerr.rdbuf());
+    SharedGraph shared;
+    if ( !( segment.empty()) && !( publish) && shared.attach( segment))
+    {
+        std::cerr << "Attached to " << segment << "\n";
+        shared.detach();
+        serveShared( segment, numSlots, socketPath);
+        return 0;
+    }
+    Graph G;
+    DIMACS9DoubleReader<Graph> reader( basePath + map + "/" + map + "_dist.gr",
+                                basePath + map + "/" + map + "_travel.gr", basePath + map + "/" + map + ".co");
+    filetrace = map + "_trace.dat";
+    o_debug.open(filetrace.c_str(), std::fstream::app);
+    Timer timer;
+    // read the input graph once, every query is answered on it
+    timer.start();
+    G.read(&reader);
+    std::cerr << "Time spent to read the graph:\t" << timer.getElapsedTime() << "sec" << std::endl;
+    if ( !( segment.empty()))
+    {
+        if ( !( SharedGraph::create( segment, G)))
+        {
+            std::cerr << "Cannot write the graph to " << segment << "\n";
+            return 1;
+        }
+        if ( !( publish)) serveShared( segment, numSlots, socketPath);
+        return 0;
+    }
+    serveWith( G, reader.getIds(), algorithmVariant, socketPath);
+    o_debug.close();
+    return 0;
+}
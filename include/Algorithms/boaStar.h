@@ -0,0 +1,179 @@
+#ifndef BOASTAR_H
+#define BOASTAR_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <limits>
+#include <cmath>
+
+/**
+ * @class BOAStar
+ *
+ * @brief Bi-Objective A* (BOA*). Implementation for graphs with edges labeled with exactly two criteria
+ *
+ * Labels are extracted in lexicographic order of their evaluation vector (f), hence every label extracted at a node
+ * has a first criterion not smaller than the ones extracted before. Therefore a label is dominated by the closed labels
+ * of its node if and only if its second criterion is not smaller than the minimum second criterion closed at the node
+ * (g2_min), and it is dominated by the solutions if and only if its f2 is not smaller than g2_min of the target. Both
+ * checks are constant time and no open or closed lists are kept per node.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class BOAStar
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::NodeData        NodeData;
+
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+    typedef typename PriorityQueueType::PQItem PQItem;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria, it must be 2
+     * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is visited or not
+     */
+    BOAStar( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph)
+    {
+        assert( m_numCriteria == 2);
+    }
+
+    /**
+     * @brief Sets the approximation factor of both criteria. A label is pruned when a solution (1+epsilon)-dominates
+     * its evaluation vector, so every Pareto efficient cost is (1+epsilon)-dominated by one of the solutions returned.
+     * An empty vector (the default) runs the exact search
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        NodeIterator u, lastNode;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            u->g_op.clear();
+            u->g_cl.clear();
+            u->heuristicSet.clear();
+            u->g2_min = std::numeric_limits<unsigned int>::max();
+        }
+        m_heuristicEngine.init( s, t, nCriteria);
+        pq.clear();
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
+
+        m_generatedLabels = 0;
+        ++(*m_timestamp);
+
+        pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s);
+
+        while( !pq.empty())
+        {
+            CriteriaList f_u = pq.minKey();
+            u = pq.minItem();
+            pq.popMin();
+
+            CriteriaList g_u = f_u - u->heuristicList;
+            if ( ( g_u[1] >= u->g2_min) || isApproximatedBySolutions( t, f_u))
+            {
+                continue;
+            }
+            u->g2_min = g_u[1];
+            ++m_generatedLabels;
+
+            if (DEBUG == 1) {
+                o_debug << "\nIT: " << m_generatedLabels << "\nExtracting |" << u->id << "| ";
+                o_debug << "f: (";
+                f_u.print( o_debug, ", ");
+                o_debug << ") g: (";
+                g_u.print(o_debug, ", ");
+                o_debug << ")";
+                o_debug << std::endl;
+            }
+
+            if ( u == t)
+            {
+                t->g_cl.push_back( Label( g_u, t->getDescriptor(), 0));
+                continue;
+            }
+
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                if ( !( isReachable( v)))
+                {
+                    continue;
+                }
+                CriteriaList g_v = g_u + e->criteriaList;
+                if ( g_v[1] >= v->g2_min)
+                {
+                    continue;
+                }
+                CriteriaList f_v = g_v + v->heuristicList;
+                if ( isApproximatedBySolutions( t, f_v))
+                {
+                    continue;
+                }
+                pq.insert( f_v, v);
+            }
+        }
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_generatedLabels;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    std::vector<double> m_epsilon;
+
+    /**
+     * @brief Checks whether f is (1+epsilon)-dominated by a solution. The first criterion of the solutions is never
+     * greater than the one of f, hence only the second criterion needs to be checked
+     */
+    bool isApproximatedBySolutions( const NodeIterator& t, const CriteriaList& f)
+    {
+        if ( m_epsilon.empty())
+        {
+            return f[1] >= t->g2_min;
+        }
+        return t->g2_min <= floor( (1 + m_epsilon[1]) * f[1]);
+    }
+
+    /**
+     * @brief Nodes left with an empty heuristic by the engine cannot reach the target (or are out of its bounds)
+     */
+    bool isReachable( const NodeIterator& v)
+    {
+        return ( v->heuristicList[0] != std::numeric_limits<unsigned int>::max()) &&
+               ( v->heuristicList[1] != std::numeric_limits<unsigned int>::max());
+    }
+};
+
+#endif // BOASTAR_H
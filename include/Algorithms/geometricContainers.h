@@ -0,0 +1,315 @@
+#ifndef GEOMETRICCONTAINERS_H
+#define GEOMETRICCONTAINERS_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/multicriteriaGraph.h>
+#include <Utilities/preprocessingIO.h>
+#include <Utilities/threadPool.h>
+#include <fstream>
+#include <queue>
+#include <string>
+
+static std::string GEOMETRIC_CONTAINERS_FILE;  // binary file caching the containers between runs (empty: not cached)
+
+/**
+ * @class GeometricContainers
+ *
+ * @brief Multicriteria geometric containers. Goal directed pruning without a partition of the graph
+ *
+ * The container of an edge (u,v) is the bounding box of the coordinates of the nodes w such that the edge starts a
+ * Pareto efficient path from u to w. A query towards t only needs the edges whose container holds t.
+ *
+ * The containers of the edges leaving u are computed by a one-to-all Pareto search from u in which every label is
+ * tagged with the first edge of its path; the final labels of every node w widen the containers of their tags. Every
+ * source node is an independent task of a thread pool, which writes only the containers of its own edges.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class GeometricContainers
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    struct BoundingBox
+    {
+        BoundingBox(): xmin( std::numeric_limits<unsigned int>::max()), xmax( 0),
+                       ymin( std::numeric_limits<unsigned int>::max()), ymax( 0)
+        {
+        }
+        void add( const unsigned int& x, const unsigned int& y)
+        {
+            xmin = std::min( xmin, x);
+            xmax = std::max( xmax, x);
+            ymin = std::min( ymin, y);
+            ymax = std::max( ymax, y);
+        }
+        bool contains( const unsigned int& x, const unsigned int& y) const
+        {
+            return ( xmin <= x) && ( x <= xmax) && ( ymin <= y) && ( y <= ymax);
+        }
+        unsigned int xmin, xmax, ymin, ymax;
+    };
+
+    GeometricContainers( GraphType& graph, unsigned int numCriteria):
+                        G(graph), m_numCriteria(numCriteria), m_preprocessed(false), m_generatedLabels(0)
+    {
+    }
+
+    bool isPreprocessed() const
+    {
+        return m_preprocessed;
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+    /**
+     * @brief Checks whether the container of an edge holds a node
+     */
+    bool contains( const EdgeIterator& e, const NodeIterator& t) const
+    {
+        return m_boxes[e->id].contains( t->x, t->y);
+    }
+
+    const BoundingBox& getContainer( const EdgeIterator& e) const
+    {
+        return m_boxes[e->id];
+    }
+
+    /**
+     * @brief Computes the container of every edge. The source nodes are processed in parallel
+     */
+    void preprocess()
+    {
+        std::cout << "Preprocessing geometric containers...\n";
+        buildGraph();
+        m_boxes.assign( m_numEdges, BoundingBox());
+        std::vector<unsigned int> generatedLabels( m_firstEdge.size() - 1, 0);
+
+        ThreadPool pool;
+        std::vector< std::vector<Bag> > bags( pool.size(), std::vector<Bag>( m_firstEdge.size() - 1));
+        pool.parallelFor( m_firstEdge.size() - 1, [&]( unsigned int u, unsigned int thread)
+        {
+            generatedLabels[u] = widenContainers( u, bags[thread]);
+        });
+
+        m_generatedLabels = 0;
+        for ( unsigned int u = 0; u < generatedLabels.size(); ++u)
+        {
+            m_generatedLabels += generatedLabels[u];
+        }
+        clearGraph();
+        m_preprocessed = true;
+        std::cout << "\tGenerated labels: " << m_generatedLabels << "\n";
+    }
+
+    /**
+     * @brief Writes the containers of the edges, in the order of the edges of the graph
+     */
+    void save( const std::string& filename)
+    {
+        std::ofstream out( filename.c_str(), std::ios::binary);
+        unsigned int numNodes = G.getNumNodes();
+        unsigned long long checksum = getGraphChecksum( G, m_numCriteria);
+        writeValue( out, numNodes);
+        writeValue( out, m_numEdges);
+        writeValue( out, checksum);
+        if ( !m_boxes.empty()) out.write( reinterpret_cast<const char*>( &m_boxes[0]), m_boxes.size() * sizeof( BoundingBox));
+    }
+
+    /**
+     * @brief Reads the containers written by save
+     *
+     * @return False if the file does not exist or it was written for another graph
+     */
+    bool load( const std::string& filename)
+    {
+        std::ifstream in( filename.c_str(), std::ios::binary);
+        if ( !in.good()) return false;
+        m_numEdges = numberEdges( G);
+        unsigned int numNodes, numEdges;
+        unsigned long long checksum;
+        readValue( in, numNodes);
+        readValue( in, numEdges);
+        readValue( in, checksum);
+        if ( !in.good() || numNodes != G.getNumNodes() || numEdges != m_numEdges || checksum != getGraphChecksum( G, m_numCriteria))
+        {
+            return false;
+        }
+        m_boxes.resize( m_numEdges);
+        if ( !m_boxes.empty()) in.read( reinterpret_cast<char*>( &m_boxes[0]), m_boxes.size() * sizeof( BoundingBox));
+        m_preprocessed = in.good();
+        return m_preprocessed;
+    }
+
+private:
+    /**
+     * @brief Labels of a node, each one tagged with the first edge of its path
+     */
+    typedef std::vector< std::pair<CriteriaList, unsigned int> > Bag;
+
+    struct Entry
+    {
+        Entry( const CriteriaList& key, const unsigned int& node, const unsigned int& firstEdge):
+               g( key), u( node), edge( firstEdge)
+        {
+        }
+        CriteriaList g;
+        unsigned int u, edge;
+    };
+
+    struct EntryComparator
+    {
+        bool operator()( const Entry& a, const Entry& b) const
+        {
+            return b.g < a.g;
+        }
+    };
+
+    GraphType& G;
+    unsigned int m_numCriteria;
+    bool m_preprocessed;
+    unsigned int m_generatedLabels;
+    unsigned int m_numEdges;
+    std::vector<BoundingBox> m_boxes;            // [edge id]
+
+    // forward graph by node id, only alive during the preprocessing
+    std::vector<unsigned int> m_firstEdge, m_target, m_edgeId, m_x, m_y;
+    std::vector<CriteriaList> m_cost;
+
+    void buildGraph()
+    {
+        NodeIterator u, lastNode;
+        EdgeIterator e, lastEdge;
+        unsigned int maxId = 0;
+        m_numEdges = numberEdges( G);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_firstEdge.assign( maxId + 2, 0);
+        m_x.assign( maxId + 1, 0);
+        m_y.assign( maxId + 1, 0);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                ++m_firstEdge[u->id + 1];
+            }
+            m_x[u->id] = u->x;
+            m_y[u->id] = u->y;
+        }
+        for ( unsigned int v = 0; v <= maxId; ++v)
+        {
+            m_firstEdge[v + 1] += m_firstEdge[v];
+        }
+        m_target.resize( m_numEdges);
+        m_edgeId.resize( m_numEdges);
+        m_cost.resize( m_numEdges);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            unsigned int i = m_firstEdge[u->id];
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e, ++i)
+            {
+                m_target[i] = G.target(e)->id;
+                m_edgeId[i] = e->id;
+                m_cost[i] = e->criteriaList;
+            }
+        }
+    }
+
+    void clearGraph()
+    {
+        std::vector<unsigned int>().swap( m_firstEdge);
+        std::vector<unsigned int>().swap( m_target);
+        std::vector<unsigned int>().swap( m_edgeId);
+        std::vector<unsigned int>().swap( m_x);
+        std::vector<unsigned int>().swap( m_y);
+        std::vector<CriteriaList>().swap( m_cost);
+    }
+
+    /**
+     * @brief Inserts a tagged label unless a label of the bag dominates it, and removes the labels it dominates
+     */
+    static bool insert( Bag& bag, const CriteriaList& g, const unsigned int& edge)
+    {
+        for ( unsigned int i = 0; i < bag.size(); ++i)
+        {
+            if ( bag[i].first.dominates( g)) return false;
+        }
+        unsigned int last = 0;
+        for ( unsigned int i = 0; i < bag.size(); ++i)
+        {
+            if ( !( bag[i].first.isDominatedBy( g))) bag[last++] = bag[i];
+        }
+        bag.resize( last);
+        bag.push_back( std::make_pair( g, edge));
+        return true;
+    }
+
+    static bool contains( const Bag& bag, const CriteriaList& g, const unsigned int& edge)
+    {
+        for ( unsigned int i = 0; i < bag.size(); ++i)
+        {
+            if ( bag[i].second == edge && bag[i].first == g) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Runs the tagged one-to-all search from the node with id u and widens the containers of its edges
+     *
+     * @return The number of labels settled
+     */
+    unsigned int widenContainers( const unsigned int& u, std::vector<Bag>& bags)
+    {
+        std::priority_queue< Entry, std::vector<Entry>, EntryComparator> queue;
+        std::vector<unsigned int> touched;
+        unsigned int generatedLabels = 0;
+        for ( unsigned int i = m_firstEdge[u]; i < m_firstEdge[u + 1]; ++i)
+        {
+            unsigned int v = m_target[i];
+            if ( bags[v].empty()) touched.push_back( v);
+            if ( insert( bags[v], m_cost[i], m_edgeId[i]))
+            {
+                queue.push( Entry( m_cost[i], v, m_edgeId[i]));
+            }
+        }
+        while ( !queue.empty())
+        {
+            Entry entry = queue.top();
+            queue.pop();
+            if ( !( contains( bags[entry.u], entry.g, entry.edge))) continue;
+            ++generatedLabels;
+            for ( unsigned int i = m_firstEdge[entry.u]; i < m_firstEdge[entry.u + 1]; ++i)
+            {
+                unsigned int v = m_target[i];
+                if ( v == u) continue;
+                CriteriaList g_v = entry.g + m_cost[i];
+                if ( bags[v].empty()) touched.push_back( v);
+                if ( insert( bags[v], g_v, entry.edge))
+                {
+                    queue.push( Entry( g_v, v, entry.edge));
+                }
+            }
+        }
+        // the boxes of the edges of u are only written by this task
+        for ( unsigned int j = 0; j < touched.size(); ++j)
+        {
+            unsigned int w = touched[j];
+            for ( unsigned int k = 0; k < bags[w].size(); ++k)
+            {
+                m_boxes[bags[w][k].second].add( m_x[w], m_y[w]);
+            }
+            bags[w].clear();
+        }
+        return generatedLabels;
+    }
+};
+
+#endif // GEOMETRICCONTAINERS_H
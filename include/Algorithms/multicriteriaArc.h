@@ -2,632 +2,1066 @@
 #define MULTICRITERIAARC_H
 
 #include <Structs/Trees/priorityQueue.h>
-#include <Utilities/geographic.h>
-#include <Algorithms/basicGraphAlgorithms.h>
-
+#include <Algorithms/multicriteriaGraph.h>
+#include <Utilities/preprocessingIO.h>
+#include <Utilities/threadPool.h>
+#include <fstream>
+#include <memory>
+#include <string>
+
+static std::string ARC_FLAGS_FILE;  // binary file caching the arc flags between runs (empty: not cached)
+
+/**
+ * @class MulticriteriaArc
+ *
+ * @brief Multicriteria arc-flags preprocessing
+ *
+ * The nodes are partitioned in a hierarchy of cells (see Partition), and every edge gets one flag per cell of every
+ * level, relative to its parent cell. The flag of a cell C is set for an edge (u,v), whose source u lies in the parent
+ * cell of C, if the edge starts a Pareto efficient path from u to a node of C. Such a path enters C for the last time
+ * through a boundary node of C (a node of C with an edge coming from another cell), so it is enough to run a backward
+ * one-to-all Pareto search from every boundary node: an edge (u,v) lies on a Pareto efficient path to the boundary
+ * node if a label of v plus the cost of the edge is a label of u. The edges leading to nodes of C are always flagged.
+ *
+ * A query towards t uses, at every node u, the flags of the coarsest level in which u and t lie in different cells
+ * (see getFlagBit).
+ *
+ * Every cell is an independent task of a thread pool, with private bags and flags. The flags are merged into a bitset
+ * per edge, indexed by the id of the edge, and they can be saved to and loaded from a binary file. A change of the
+ * criteria of a few edges only recomputes the cells it affects (see updateWeights).
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
 template<class GraphType>
-class MulticriteriaArc;
-
-template<class GraphType, template <typename graphType> class HeuristicType>
-class NamoaStarArc
+class MulticriteriaArc
 {
 public:
-	typedef typename GraphType::NodeIterator    NodeIterator;
-	typedef typename GraphType::EdgeIterator    EdgeIterator;
-	typedef typename GraphType::SizeType        SizeType;
-	typedef typename GraphType::NodeData        NodeData;
-
-	typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
-	typedef typename PriorityQueueType::PQItem PQItem;   
-	
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef PriorityQueue< CriteriaList, unsigned int, HeapStorage> PriorityQueueType;
+
     /**
-     * @brief Constructor
+     * @class Partition
      *
-     * @param graph The graph to run the algorithm on
-     * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is visited or not
+     * @brief Balanced multilevel partition of the nodes by their coordinates (kd-tree)
+     *
+     * The nodes are split in numCells cells of (almost) the same size, and every cell is split again in numCells
+     * cells, numLevels times. A split halves the number of cells and cuts the nodes at the proportional position
+     * along the widest coordinate, so any number of cells is allowed. Level numLevels-1 is the coarsest one.
      */
-    NamoaStarArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):G(graph),m_numCriteria(numCriteria),m_timestamp(timestamp),m_heuristicEngine(graph),m_arcDijkstra(graph, numCriteria, timestamp)
+    class Partition
+    {
+    public:
+
+        Partition(): m_numCells(1), m_numLevels(1)
+        {
+        }
+
+        /**
+         * @brief Partitions the nodes, given by id. The coordinates are indexed by id as well
+         */
+        void build( std::vector<unsigned int> ids, const std::vector<unsigned int>& x, const std::vector<unsigned int>& y,
+                    const unsigned int& numCells, const unsigned int& numLevels)
+        {
+            assert( numCells > 0 && numLevels > 0);
+            m_numCells = numCells;
+            m_numLevels = numLevels;
+            m_x = &x;
+            m_y = &y;
+            m_cell.assign( numLevels, std::vector<unsigned int>( x.size(), 0));
+            m_globalCell.assign( numLevels, std::vector<unsigned int>( x.size(), 0));
+            divide( ids, 0, ids.size(), numLevels - 1, 0);
+        }
+
+        /**
+         * @brief Returns the index of the cell of a node at a level, relative to its parent cell
+         */
+        unsigned int getCell( const unsigned int& id, const unsigned int& level = 0) const
+        {
+            return m_cell[level][id];
+        }
+
+        /**
+         * @brief Returns the index of the cell of a node at a level, among all the cells of the level
+         */
+        unsigned int getGlobalCell( const unsigned int& id, const unsigned int& level = 0) const
+        {
+            return m_globalCell[level][id];
+        }
+
+        /**
+         * @brief Returns the number of cells a cell is split in
+         */
+        unsigned int getNumCells() const
+        {
+            return m_numCells;
+        }
+
+        unsigned int getNumLevels() const
+        {
+            return m_numLevels;
+        }
+
+        unsigned int getMaxLevel() const
+        {
+            return m_numLevels - 1;
+        }
+
+        /**
+         * @brief Returns the coarsest level in which two nodes lie in different cells, or 0 if they share all of them
+         */
+        unsigned int getLevel( const unsigned int& u, const unsigned int& v) const
+        {
+            for ( unsigned int level = getMaxLevel(); level > 0; --level)
+            {
+                if ( m_cell[level][u] != m_cell[level][v]) return level;
+            }
+            return 0;
+        }
+
+    private:
+        unsigned int m_numCells, m_numLevels;
+        const std::vector<unsigned int>* m_x;
+        const std::vector<unsigned int>* m_y;
+        std::vector< std::vector<unsigned int> > m_cell;        // [level][id]
+        std::vector< std::vector<unsigned int> > m_globalCell;  // [level][id]
+
+        void divide( std::vector<unsigned int>& ids, const unsigned int& begin, const unsigned int& end,
+                     const unsigned int& level, const unsigned int& globalParent)
+        {
+            std::vector<unsigned int> bounds( 1, begin);
+            split( ids, begin, end, m_numCells, bounds);
+            for ( unsigned int cell = 0; cell < m_numCells; ++cell)
+            {
+                for ( unsigned int i = bounds[cell]; i < bounds[cell + 1]; ++i)
+                {
+                    m_cell[level][ids[i]] = cell;
+                    m_globalCell[level][ids[i]] = globalParent * m_numCells + cell;
+                }
+                if ( level > 0)
+                {
+                    divide( ids, bounds[cell], bounds[cell + 1], level - 1, globalParent * m_numCells + cell);
+                }
+            }
+        }
+
+        /**
+         * @brief Splits a range of nodes in a number of parts, appending the end of every part to bounds
+         */
+        void split( std::vector<unsigned int>& ids, const unsigned int& begin, const unsigned int& end,
+                    const unsigned int& parts, std::vector<unsigned int>& bounds)
+        {
+            if ( parts == 1)
+            {
+                bounds.push_back( end);
+                return;
+            }
+            const std::vector<unsigned int>* coordinate = ( extent( ids, begin, end, *m_x) >= extent( ids, begin, end, *m_y)) ? m_x : m_y;
+            unsigned int left = parts / 2;
+            unsigned int middle = begin + (unsigned int)( (unsigned long long)( end - begin) * left / parts);
+            std::nth_element( ids.begin() + begin, ids.begin() + middle, ids.begin() + end, CoordinateLess( *coordinate));
+            split( ids, begin, middle, left, bounds);
+            split( ids, middle, end, parts - left, bounds);
+        }
+
+        static unsigned int extent( const std::vector<unsigned int>& ids, const unsigned int& begin, const unsigned int& end,
+                                    const std::vector<unsigned int>& coordinate)
+        {
+            if ( begin == end) return 0;
+            unsigned int minimum = coordinate[ids[begin]], maximum = minimum;
+            for ( unsigned int i = begin + 1; i < end; ++i)
+            {
+                minimum = std::min( minimum, coordinate[ids[i]]);
+                maximum = std::max( maximum, coordinate[ids[i]]);
+            }
+            return maximum - minimum;
+        }
+
+        struct CoordinateLess
+        {
+            CoordinateLess( const std::vector<unsigned int>& coordinate): m_coordinate( coordinate)
+            {
+            }
+            bool operator()( const unsigned int& a, const unsigned int& b) const
+            {
+                return m_coordinate[a] < m_coordinate[b];
+            }
+            const std::vector<unsigned int>& m_coordinate;
+        };
+    };
+
+    MulticriteriaArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                    G(graph),
+                    m_numCriteria(numCriteria),
+                    m_timestamp(timestamp),
+                    m_preprocessed(false),
+                    m_generatedLabels(0),
+                    m_numCells(32),
+                    m_numLevels(1)
     {
     }
-    
-    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
-	{
-		NodeIterator u, lastNode;
-		for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
-		    u->labels.clear();
-		}
-        m_heuristicEngine.init( s, t, nCriteria);
-		pq.clear();
-	}
 
     /**
-     * @brief Builds a shortest path tree routed on a source node
-     *
-     * @param s The source node
+     * @brief Sets the number of cells a cell is split in, and the number of levels of the partition. Default: 32 cells
+     * in a single level
      */
-    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    void setPartitionSize( const unsigned int& numCells, const unsigned int& numLevels)
+    {
+        assert( numCells > 0 && numLevels > 0);
+        m_numCells = numCells;
+        m_numLevels = numLevels;
+        m_preprocessed = false;
+    }
+
+    const Partition& getPartition() const
     {
-		NodeIterator u,v,lastNode;
-		EdgeIterator e,lastEdge;
+        return m_partition;
+    }
 
-        m_generatedLabels = 1;
-		assert( hasFeasiblePotentials(t));
-		++(*m_timestamp);
-		
+    bool isPreprocessed() const
+    {
+        return m_preprocessed;
+    }
 
-		unsigned int* pqitem = new unsigned int();
-		s->labels.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem));
-		pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s, pqitem);
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
 
-        unsigned int mask = m_arcDijkstra.getPartition().getOnMask( m_arcDijkstra.getPartition().getCell( t->x, t->y));
+    /**
+     * @brief Returns the position of the flag used by the edges leaving u on a query towards t
+     */
+    unsigned int getFlagBit( const NodeIterator& u, const NodeIterator& t) const
+    {
+        unsigned int level = m_partition.getLevel( u->id, t->id);
+        return level * m_numCells + m_partition.getCell( t->id, level);
+    }
 
-		while( !pq.empty())
-		{
-		    CriteriaList minCriteria = pq.min().key;
-		    u = pq.minItem();
-		    pq.popMin();
+    bool isFlagged( const EdgeIterator& e, const unsigned int& bit) const
+    {
+        return ( m_flags[e->id * m_bytesPerEdge + bit / 8] >> ( bit % 8)) & 1;
+    }
 
-			CriteriaList g_u = minCriteria - u->heuristicList;
-			
-			if( u == t)
+    /**
+     * @brief Partitions the nodes and numbers the edges
+     */
+    void partition()
+    {
+        NodeIterator u, lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        std::vector<unsigned int> ids;
+        m_x.assign( maxId + 1, 0);
+        m_y.assign( maxId + 1, 0);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            ids.push_back( u->id);
+            m_x[u->id] = u->x;
+            m_y[u->id] = u->y;
+        }
+        m_numEdges = numberEdges( G);
+        m_partition.build( ids, m_x, m_y, m_numCells, m_numLevels);
+        m_bytesPerEdge = ( m_numCells * m_numLevels + 7) / 8;
+
+        m_cells.clear();
+        m_firstCell.assign( m_numLevels, 0);
+        unsigned int levelCells = 1;
+        for ( unsigned int level = m_numLevels; level-- > 0; )
+        {
+            levelCells *= m_numCells;
+            m_firstCell[level] = m_cells.size();
+            for ( unsigned int cell = 0; cell < levelCells; ++cell)
             {
-                eraseAllDominatedLabels( G, t, g_u);
+                m_cells.push_back( std::make_pair( level, cell));
             }
-			
-			moveToClosed( g_u, u);
-
-			if ( isDominatedByNodeLabels( t, minCriteria)) continue;
-
-		    //std::cout << "extracting " << u->id << " with label ";
-		    //label.print(std::cout, G);
-		    //std::cout << std::endl; 
-
-		  	for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-		    {
-                if( ! (e->flags & mask)) continue;
-
-				v = G.target(e);
-				
-				if ( v->timestamp != (*m_timestamp))
-				{
-					v->labels.clear();
-					v->timestamp = (*m_timestamp);
-				}
-				
-				CriteriaList g_v = g_u + e->criteriaList;
-				CriteriaList heuristicCost = g_v + v->heuristicList;
-
-				if ( distanceExistsInNode( v, g_v))
-				{
-					v->labels.push_back( Label( g_v, u->getDescriptor(), 0) );
-                    ++m_generatedLabels;
-				}
-				else	
-				{
-					if( isDominatedByNodeLabels( v, g_v)) continue;
-					eraseDominatedLabels( G, v, g_v);
-					if( isDominatedByNodeLabels(t, heuristicCost)) continue;
-					unsigned int* pqitem = new unsigned int();
-					v->labels.push_back( Label( g_v, u->getDescriptor(), pqitem) );
-				    ++m_generatedLabels;
-					pq.insert( heuristicCost, v, pqitem);
-				}
-		    }
-		}
+        }
     }
 
-    const unsigned int& getGeneratedLabels()
+    /**
+     * @brief Computes the flags of every edge. The cells are processed in parallel
+     */
+    void preprocess()
     {
-        return m_generatedLabels;
+        std::cout << "Preprocessing Arc Flags...\n";
+        partition();
+        buildReverseGraph();
+        std::vector<unsigned int> indices( m_cells.size());
+        for ( unsigned int i = 0; i < indices.size(); ++i)
+        {
+            indices[i] = i;
+        }
+        m_flags.assign( m_numEdges * m_bytesPerEdge, 0);
+        flagCells( indices);
+        clearReverseGraph();
+        m_preprocessed = true;
+        std::cout << "\tGenerated labels: " << m_generatedLabels << "\n";
     }
-    
+
     /**
-     * @brief Runs a shortest path query between a source node s and a target node t
+     * @brief Changes the criteria of some edges, in the graph and in its incoming edges, and repairs the flags
      *
-     * @param s The source node
-     * @param t The target node
-     * @return The distance of the target node
+     * The flags of a cell only depend on the Pareto efficient paths to its boundary nodes. A changed edge (u,v) only
+     * changes them if, for a boundary node b, a path from v to b plus the edge, with its old or its new criteria, is an
+     * efficient path from u to b or is not dominated by one. So two forward one-to-all searches on the graph before the
+     * change, from u and from v, give the cells the edge affects, and only those are computed again. When these
+     * searches outnumber the backward searches of all the cells, one per boundary node, every cell is computed again.
      *
-    WeightType runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+     * @param changes Pairs (edge id, new criteria), see Edge::id
+     * @return The number of cells computed again, 0 if the flags were not computed yet
+     */
+    unsigned int updateWeights( const std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+    {
+        NodeIterator u, lastNode;
+        EdgeIterator e, lastEdge;
+        if ( !m_preprocessed) partition();
+        std::vector<int> change( m_numEdges, -1);
+        for ( unsigned int i = 0; i < changes.size(); ++i)
+        {
+            assert( changes[i].first < m_numEdges && changes[i].second.size() == m_numCriteria);
+            change[changes[i].first] = i;
+        }
+        std::vector<EdgeChange> changed;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                if ( ( change[e->id] < 0) || ( e->criteriaList == changes[change[e->id]].second)) continue;
+                changed.push_back( EdgeChange( u->id, G.target(e)->id, e->id, e->criteriaList, changes[change[e->id]].second));
+            }
+        }
+        if ( !m_preprocessed || changed.empty())
+        {
+            applyChanges( changed);
+            return 0;
+        }
+
+        buildReverseGraph();
+        std::vector< std::vector<unsigned int> > boundary;
+        unsigned int numBoundaryNodes = findBoundaries( boundary);
+        if ( 2 * changed.size() >= numBoundaryNodes)
+        {
+            clearReverseGraph();
+            applyChanges( changed);
+            preprocess();
+            return m_cells.size();
+        }
+        std::vector<char> isAffected;
+        findAffectedCells( changed, boundary, isAffected);
+        applyChanges( changed);
+        std::vector<unsigned int> indices;
+        for ( unsigned int i = 0; i < m_cells.size(); ++i)
+        {
+            if ( isAffected[i]) indices.push_back( i);
+        }
+
+        // forget the flags of the affected cells, the edges into the cells are flagged again
+        for ( unsigned int v = 0; v + 1 < m_inOffset.size(); ++v)
+        {
+            for ( unsigned int i = m_inOffset[v]; i < m_inOffset[v + 1]; ++i)
+            {
+                const unsigned int edge = m_inEdge[i];
+                for ( unsigned int j = 0; j < indices.size(); ++j)
+                {
+                    const unsigned int cell = indices[j];
+                    if ( isInParent( m_inSource[i], m_cells[cell].first, m_cells[cell].second))
+                    {
+                        unsigned int bit = getBit( cell);
+                        m_flags[edge * m_bytesPerEdge + bit / 8] &= ~( 1 << ( bit % 8));
+                    }
+                }
+            }
+        }
+        flagCells( indices);
+        clearReverseGraph();
+        std::cout << "Arc Flags repaired in " << indices.size() << " of " << m_cells.size() << " cells\n";
+        std::cout << "\tGenerated labels: " << m_generatedLabels << "\n";
+        return indices.size();
+    }
+
+    /**
+     * @brief Writes the flags of the edges, a bitset per edge in the order of the edges of the graph
+     */
+    void save( const std::string& filename)
     {
+        std::ofstream out( filename.c_str(), std::ios::binary);
+        unsigned int numNodes = G.getNumNodes();
+        unsigned long long checksum = getGraphChecksum( G, m_numCriteria);
+        writeValue( out, numNodes);
+        writeValue( out, m_numEdges);
+        writeValue( out, m_numCells);
+        writeValue( out, m_numLevels);
+        writeValue( out, checksum);
+        if ( !m_flags.empty()) out.write( reinterpret_cast<const char*>( &m_flags[0]), m_flags.size());
+    }
 
-    }*/
+    /**
+     * @brief Reads the flags written by save
+     *
+     * @return False if the file does not exist or it was written for another graph or partition
+     */
+    bool load( const std::string& filename)
+    {
+        std::ifstream in( filename.c_str(), std::ios::binary);
+        if ( !in.good()) return false;
+        partition();
+        unsigned int numNodes, numEdges, numCells, numLevels;
+        unsigned long long checksum;
+        readValue( in, numNodes);
+        readValue( in, numEdges);
+        readValue( in, numCells);
+        readValue( in, numLevels);
+        readValue( in, checksum);
+        if ( !in.good() || numNodes != G.getNumNodes() || numEdges != m_numEdges || numCells != m_numCells ||
+             numLevels != m_numLevels || checksum != getGraphChecksum( G, m_numCriteria))
+        {
+            return false;
+        }
+        m_flags.resize( m_numEdges * m_bytesPerEdge);
+        if ( !m_flags.empty()) in.read( reinterpret_cast<char*>( &m_flags[0]), m_flags.size());
+        m_preprocessed = in.good();
+        return m_preprocessed;
+    }
 
 private:
     GraphType& G;
-    PriorityQueueType pq;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    bool m_preprocessed;
     unsigned int m_generatedLabels;
-	unsigned int m_numCriteria;
-	unsigned int* m_timestamp;
-    HeuristicType<GraphType> m_heuristicEngine;
-    MulticriteriaArc<GraphType> m_arcDijkstra;
-
-	bool distanceExistsInNode( const NodeIterator& v, const CriteriaList& g_v)
-	{
-		for ( std::vector<Label>::iterator it = v->labels.begin(); it != v->labels.end(); ++it)
-		{
-			if ( it->getCriteriaList() == g_v )
-		    {
-				return true;
-		    }
-		}
-		return false;		
-	}
-
-	void eraseDominatedLabels( GraphType& G, const NodeIterator& v, const CriteriaList& g_v)
-	{
-        EdgeIterator e, lastEdge;
-        NodeIterator w;
-		std::vector<Label>::iterator it = v->labels.begin();
-		while ( it != v->labels.end() )
-		{
-			if ( it->getCriteriaList().isDominatedBy(g_v) )
-		    {
-				if( it->isInQueue())
-				{
-					pq.remove( it->getPQitem());
-					moveToClosed( it->getCriteriaList(), v);
-				}
-				else
-				{
-                    // GO FORWARD IN SEARCH SPACE TO FIND MORE DOMINATED LABELS
-				    for( e = G.beginEdges(v), lastEdge = G.endEdges(v); e != lastEdge; ++e)
-		            {
-                        //std::cout << "Reducing search space...\n";
-				        w = G.target(e);
-                        eraseDominatedLabels( G, w, g_v + e->criteriaList);
-			        }
-			    }
-				it = v->labels.erase( it );
-		    }
-		    else 
-		    {
-			    ++it;
-		    }
-		}
-	}
-	
-	void eraseAllDominatedLabels(GraphType& G, const NodeIterator& t, const CriteriaList& g_v)
-	{
+    unsigned int m_numCells, m_numLevels;
+    unsigned int m_numEdges;
+    unsigned int m_bytesPerEdge;
+    Partition m_partition;
+    std::vector<unsigned int> m_x, m_y;          // coordinates by node id
+    std::vector<unsigned char> m_flags;          // [edge id * bytes per edge]
+    std::vector< std::pair<unsigned int, unsigned int> > m_cells;  // (level, global cell), coarsest level first
+    std::vector<unsigned int> m_firstCell;       // [level], position of its first cell in m_cells
+
+    enum { FLAGGED = 1, IN_TREE = 2 };          // marks of the edges while a cell is processed
+
+    /**
+     * @brief A change of the criteria of an edge, by node id
+     */
+    struct EdgeChange
+    {
+        EdgeChange( const unsigned int& u, const unsigned int& v, const unsigned int& e, const CriteriaList& oldCriteria,
+                    const CriteriaList& newCriteria): source( u), target( v), edge( e), before( oldCriteria), after( newCriteria)
+        {
+        }
+        unsigned int source, target, edge;
+        CriteriaList before, after;
+    };
+
+    // reverse graph by node id, only alive during the preprocessing
+    std::vector<unsigned int> m_inOffset, m_inSource, m_inEdge;
+    std::vector<CriteriaList> m_cost;
+
+    void buildReverseGraph()
+    {
         NodeIterator u, lastNode;
+        EdgeIterator e, lastEdge;
+        m_inOffset.assign( m_x.size() + 1, 0);
         for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
         {
-            if( u->labels.empty()) continue;
-            if( u == t) continue;
-            eraseDominatedLabels( G, u, g_v);
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                ++m_inOffset[G.target(e)->id + 1];
+            }
+        }
+        for ( unsigned int v = 0; v + 1 < m_inOffset.size(); ++v)
+        {
+            m_inOffset[v + 1] += m_inOffset[v];
+        }
+        std::vector<unsigned int> next( m_inOffset.begin(), m_inOffset.end() - 1);
+        m_inSource.resize( m_numEdges);
+        m_inEdge.resize( m_numEdges);
+        m_cost.resize( m_numEdges);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                unsigned int i = next[G.target(e)->id]++;
+                m_inSource[i] = u->id;
+                m_inEdge[i] = e->id;
+                m_cost[e->id] = e->criteriaList;
+            }
         }
     }
 
+    void clearReverseGraph()
+    {
+        std::vector<unsigned int>().swap( m_inOffset);
+        std::vector<unsigned int>().swap( m_inSource);
+        std::vector<unsigned int>().swap( m_inEdge);
+        std::vector<CriteriaList>().swap( m_cost);
+    }
 
-    bool hasFeasiblePotentials( const typename GraphType::NodeIterator& t)
+    /**
+     * @brief Returns the flag of a cell, given by its position in m_cells
+     */
+    unsigned int getBit( const unsigned int& cell) const
     {
-        NodeIterator u,v,lastNode;
-        EdgeIterator e,lastEdge;
+        return m_cells[cell].first * m_numCells + m_cells[cell].second % m_numCells;
+    }
 
+    /**
+     * @brief Sets the criteria of the changed edges, in the graph, in its incoming edges and in the reverse graph if
+     * it exists
+     */
+    void applyChanges( const std::vector<EdgeChange>& changed)
+    {
+        std::vector<int> change( m_numEdges, -1);
+        for ( unsigned int j = 0; j < changed.size(); ++j)
+        {
+            change[changed[j].edge] = j;
+            if ( !m_cost.empty()) m_cost[changed[j].edge] = changed[j].after;
+        }
+        NodeIterator u, lastNode;
+        EdgeIterator e, lastEdge;
         for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
         {
             for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
             {
-                v = G.target(e);
-				CriteriaList c_e = e->criteriaList;
-				CriteriaList c_v = v->heuristicList;
-				CriteriaList c_u = u->heuristicList;
-                if( e->criteriaList + v->heuristicList < u->heuristicList)
+                if ( change[e->id] < 0) continue;
+                e->criteriaList = changed[change[e->id]].after;
+                G.getInEdgeIterator( e)->criteriaList = e->criteriaList;
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the boundary nodes of every cell, by position in m_cells, with the reverse graph
+     *
+     * @return The number of boundary nodes of all the cells
+     */
+    unsigned int findBoundaries( std::vector< std::vector<unsigned int> >& boundary) const
+    {
+        unsigned int numBoundaryNodes = 0;
+        boundary.assign( m_cells.size(), std::vector<unsigned int>());
+        for ( unsigned int v = 0; v + 1 < m_inOffset.size(); ++v)
+        {
+            for ( unsigned int level = 0; level < m_numLevels; ++level)
+            {
+                unsigned int cell = m_partition.getGlobalCell( v, level);
+                for ( unsigned int i = m_inOffset[v]; i < m_inOffset[v + 1]; ++i)
                 {
-                    return false;
+                    if ( m_partition.getGlobalCell( m_inSource[i], level) == cell) continue;
+                    boundary[m_firstCell[level] + cell].push_back( v);
+                    ++numBoundaryNodes;
+                    break;
                 }
-            }       
+            }
         }
-        return true;
+        return numBoundaryNodes;
     }
 
-	
-
-	bool isDominatedByNodeLabels( const NodeIterator& v, const CriteriaList& g_v)
-	{
-		for ( std::vector<Label>::iterator it = v->labels.begin(); it != v->labels.end(); ++it)
-		{
-			if ( it->getCriteriaList().dominates(g_v) )
-		    {
-				return true;
-		    }
-		}
-		return false;
-	}
-
-	void moveToClosed( const CriteriaList& g_u, const NodeIterator& u)
-	{
-		for ( std::vector<Label>::iterator it = u->labels.begin(); it != u->labels.end(); ++it)
-		{
-			if ( (it->isInQueue()) && (it->getCriteriaList() == g_u) )
-		    {
-				it->deletePQitem();
-		    }
-		}		
-	}
-	
-};
-
-template<class GraphType>
-class MulticriteriaArc
-{
-public:
-	typedef typename GraphType::NodeIterator    NodeIterator;
-	typedef typename GraphType::NodeDescriptor  NodeDescriptor;
-	typedef typename GraphType::EdgeIterator    EdgeIterator;
-	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
-	typedef typename GraphType::SizeType        SizeType;
-	typedef typename GraphType::NodeData        NodeData;
-	typedef PriorityQueue< Label, NodeIterator, HeapStorage> PriorityQueueType;
-	typedef typename PriorityQueueType::PQItem PQItem;   
-	
-    class Partition
+    /**
+     * @brief Finds the cells affected by the changed edges, whose criteria must not be applied yet (see
+     * updateWeights). The edges are processed in parallel
+     *
+     * @param isAffected Set to 1 for the affected cells, by position in m_cells
+     */
+    void findAffectedCells( const std::vector<EdgeChange>& changed, const std::vector< std::vector<unsigned int> >& boundary,
+                            std::vector<char>& isAffected)
     {
-    public:
-        
-        Partition()
+        // forward graph by node id
+        std::vector<unsigned int> outOffset( m_inOffset.size(), 0), outTarget( m_numEdges), outEdge( m_numEdges);
+        for ( unsigned int i = 0; i < m_numEdges; ++i)
+        {
+            ++outOffset[m_inSource[i] + 1];
+        }
+        for ( unsigned int v = 0; v + 1 < outOffset.size(); ++v)
         {
+            outOffset[v + 1] += outOffset[v];
         }
-        
-	    Partition( unsigned int xmin, unsigned int xmax, unsigned int ymin, unsigned int ymax, unsigned int div, unsigned int l = 1):
-	                        m_xmin(xmin),
-	                        m_xmax(xmax + 1),
-	                        m_ymin(ymin),
-	                        m_ymax(ymax + 1),
-	                        m_div(div),
-	                        m_numLevels(l)
-	    {    
+        std::vector<unsigned int> next( outOffset.begin(), outOffset.end() - 1);
+        for ( unsigned int v = 0; v + 1 < m_inOffset.size(); ++v)
+        {
+            for ( unsigned int i = m_inOffset[v]; i < m_inOffset[v + 1]; ++i)
+            {
+                unsigned int j = next[m_inSource[i]]++;
+                outTarget[j] = v;
+                outEdge[j] = m_inEdge[i];
+            }
         }
 
-        unsigned int getCell( unsigned int x, unsigned int y, unsigned int l = 0)
-	    {   
-	        unsigned int column = getOffsetX(x, l) / getStepXofLevel(l);
-		    unsigned int row = getOffsetY(y, l) / getStepYofLevel(l);
-		    return row*m_div + column;
-        }
-    
-        unsigned int getMaxLevel () const
+        std::vector< std::vector<char> > affected( changed.size(), std::vector<char>( m_cells.size(), 0));
+        ThreadPool pool;
+        std::vector< std::vector<ParetoBag> > sourceBags( pool.size(), std::vector<ParetoBag>( m_x.size(), ParetoBag( m_numCriteria)));
+        std::vector< std::vector<ParetoBag> > targetBags( pool.size(), std::vector<ParetoBag>( m_x.size(), ParetoBag( m_numCriteria)));
+        std::vector< std::vector<unsigned int> > sourceTouched( pool.size()), targetTouched( pool.size());
+        std::vector<PriorityQueueType> queues( pool.size());
+        pool.parallelFor( changed.size(), [&]( unsigned int j, unsigned int thread)
         {
-            return getNumLevels() - 1;
+            const EdgeChange& change = changed[j];
+            const std::vector<ParetoBag>& fromSource = sourceBags[thread];
+            const std::vector<ParetoBag>& fromTarget = targetBags[thread];
+            paretoSearch( change.source, outOffset, outTarget, outEdge, sourceBags[thread], queues[thread], sourceTouched[thread]);
+            paretoSearch( change.target, outOffset, outTarget, outEdge, targetBags[thread], queues[thread], targetTouched[thread]);
+            for ( unsigned int cell = 0; cell < m_cells.size(); ++cell)
+            {
+                for ( unsigned int b = 0; ( b < boundary[cell].size()) && !( affected[j][cell]); ++b)
+                {
+                    const ParetoBag& paths = fromTarget[boundary[cell][b]];
+                    const ParetoBag& efficient = fromSource[boundary[cell][b]];
+                    for ( unsigned int k = 0; k < paths.size(); ++k)
+                    {
+                        CriteriaList before = paths.get( k) + change.before;
+                        CriteriaList after = paths.get( k) + change.after;
+                        if ( efficient.contains( before) || efficient.contains( after) || !( efficient.isDominated( after)))
+                        {
+                            affected[j][cell] = 1;
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+
+        isAffected.assign( m_cells.size(), 0);
+        for ( unsigned int j = 0; j < changed.size(); ++j)
+        {
+            for ( unsigned int cell = 0; cell < m_cells.size(); ++cell)
+            {
+                if ( affected[j][cell]) isAffected[cell] = 1;
+            }
         }
-    
-        unsigned int getNumCells ( const unsigned int& l = 0) const
+    }
+
+    /**
+     * @brief Computes the flags of some cells, given by their position in m_cells, whose bits must be clear. The
+     * cells are processed in parallel
+     */
+    void flagCells( const std::vector<unsigned int>& indices)
+    {
+        std::vector<int> position( m_cells.size(), -1);
+        for ( unsigned int j = 0; j < indices.size(); ++j)
         {
-            return m_div * m_div;
+            position[indices[j]] = j;
         }
-    
-        unsigned int getNumLevels () const
+        std::vector< std::vector<unsigned int> > members( indices.size());
+        for ( unsigned int v = 0; v + 1 < m_inOffset.size(); ++v)
         {
-            return m_numLevels;
+            if ( m_inOffset[v] == m_inOffset[v + 1]) continue;
+            for ( unsigned int level = 0; level < m_numLevels; ++level)
+            {
+                int j = position[m_firstCell[level] + m_partition.getGlobalCell( v, level)];
+                if ( j >= 0) members[j].push_back( v);
+            }
         }
-	
-	    unsigned int getOffsetX ( const unsigned int& x, unsigned int l)
+        std::vector< std::vector<unsigned int> > flagged( indices.size());
+        std::vector<unsigned int> generatedLabels( indices.size(), 0);
+
+        ThreadPool pool;
+        std::vector< std::vector<ParetoBag> > bags( pool.size(), std::vector<ParetoBag>( m_x.size(), ParetoBag( m_numCriteria)));
+        std::vector< std::vector<char> > marks( pool.size(), std::vector<char>( m_numEdges, 0));
+        std::vector<PriorityQueueType> queues( pool.size());
+        pool.parallelFor( indices.size(), [&]( unsigned int j, unsigned int thread)
         {
-            if ( l == getMaxLevel())
-                return x-m_xmin;
-            else
-                return (x-m_xmin)%getStepXofLevel(l+1);
+            const std::pair<unsigned int, unsigned int>& cell = m_cells[indices[j]];
+            generatedLabels[j] = flagCell( cell.first, cell.second, members[j], bags[thread], queues[thread],
+                                           marks[thread], flagged[j]);
+        });
+
+        m_generatedLabels = 0;
+        for ( unsigned int j = 0; j < indices.size(); ++j)
+        {
+            m_generatedLabels += generatedLabels[j];
+            const unsigned int cell = indices[j];
+            const unsigned int bit = getBit( cell);
+            for ( unsigned int k = 0; k < flagged[j].size(); ++k)
+            {
+                m_flags[flagged[j][k] * m_bytesPerEdge + bit / 8] |= 1 << ( bit % 8);
+            }
         }
-    
-        unsigned int getOffsetY ( unsigned int y, unsigned int l)
+    }
+
+    /**
+     * @brief Checks whether the flags of a cell are needed by the edges leaving a node, i.e. the node lies in the
+     * parent of the cell
+     */
+    bool isInParent( const unsigned int& u, const unsigned int& level, const unsigned int& cell) const
+    {
+        return ( level == m_partition.getMaxLevel()) || ( m_partition.getGlobalCell( u, level + 1) == cell / m_numCells);
+    }
+
+    /**
+     * @brief Finds the edges flagged for a cell, running a backward search from every boundary node
+     *
+     * @param members The nodes of the cell
+     * @param marks Scratch array indexed by edge, all 0 on entry and on exit
+     * @param flagged The ids of the edges flagged
+     * @return The number of labels settled
+     */
+    unsigned int flagCell( const unsigned int& level, const unsigned int& cell, const std::vector<unsigned int>& members,
+                           std::vector<ParetoBag>& bags, PriorityQueueType& queue, std::vector<char>& marks,
+                           std::vector<unsigned int>& flagged)
+    {
+        std::vector<unsigned int> boundary;
+        unsigned int generatedLabels = 0;
+        for ( unsigned int j = 0; j < members.size(); ++j)
         {
-            if ( l == getMaxLevel())
-                return y-m_ymin;
-            else
-                return (y-m_ymin)%getStepYofLevel(l+1);
+            unsigned int v = members[j];
+            bool isBoundary = false;
+            for ( unsigned int i = m_inOffset[v]; i < m_inOffset[v + 1]; ++i)
+            {
+                if ( m_partition.getGlobalCell( m_inSource[i], level) != cell)
+                {
+                    isBoundary = true;
+                }
+                if ( isInParent( m_inSource[i], level, cell)) mark( m_inEdge[i], FLAGGED, marks, flagged);
+            }
+            if ( isBoundary) boundary.push_back( v);
         }
-    
-        unsigned int getOnMask( unsigned int index)
-	    {
-	        return 1 << index;
-	    }
-	
-	    unsigned int getOffMask( unsigned int index)
-	    {
-            return ~getOnMask( index);
+
+        std::vector<unsigned int> touched, tree;     // tree: the edges found on an efficient path
+        for ( unsigned int b = 0; b < boundary.size(); ++b)
+        {
+            generatedLabels += paretoSearch( boundary[b], m_inOffset, m_inSource, m_inEdge, bags, queue, touched);
+            for ( unsigned int j = 0; j < touched.size(); ++j)
+            {
+                unsigned int v = touched[j];
+                const ParetoBag& bag = bags[v];
+                for ( unsigned int i = m_inOffset[v]; i < m_inOffset[v + 1]; ++i)
+                {
+                    if ( marks[m_inEdge[i]] & IN_TREE) continue;
+                    const ParetoBag& sourceBag = bags[m_inSource[i]];
+                    for ( unsigned int k = 0; k < bag.size(); ++k)
+                    {
+                        if ( sourceBag.contains( bag.get( k) + m_cost[m_inEdge[i]]))
+                        {
+                            mark( m_inEdge[i], IN_TREE, marks, tree);
+                            if ( isInParent( m_inSource[i], level, cell)) mark( m_inEdge[i], FLAGGED, marks, flagged);
+                            break;
+                        }
+                    }
+                }
+            }
         }
-	
-	    unsigned int getStepXofLevel(unsigned int l)
+        for ( unsigned int j = 0; j < touched.size(); ++j)
         {
-            //std::cout << "Step X at level " << l << " is " << (m_xmax-m_xmin)/pow( (double)m_div, (double)m_numLevels-l) << std::endl;
-            return (m_xmax-m_xmin)/pow( (double)m_div, (double)m_numLevels-l);
+            bags[touched[j]].clear();
         }
-    
-        unsigned int getStepYofLevel(unsigned int l)
+        for ( unsigned int j = 0; j < flagged.size(); ++j)
         {
-            //std::cout << "Step Y at level " << l << " is " << (m_ymax-m_ymin)/pow( (double)m_div, (double)m_numLevels-l) << std::endl;
-            return (m_ymax-m_ymin)/pow( (double)m_div, (double)m_numLevels-l);
+            marks[flagged[j]] = 0;
         }
-        
-        void reset( unsigned int xmin, unsigned int xmax, unsigned int ymin, unsigned int ymax, unsigned int div, unsigned int l = 1)
+        for ( unsigned int j = 0; j < tree.size(); ++j)
         {
-            m_xmin = xmin;
-            m_xmax = xmax + 1;
-            m_ymin = ymin;
-            m_ymax = ymax + 1;
-            m_div = div;
-            m_numLevels = l;
+            marks[tree[j]] = 0;
         }
-	
-    private:
-        unsigned int m_xmin, m_xmax, m_ymin, m_ymax, m_div, m_numLevels;
-    };
-
+        return generatedLabels;
+    }
 
-    MulticriteriaArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
-                    G(graph),
-                    m_numCriteria(numCriteria),
-                    m_timestamp(timestamp)
+    static void mark( const unsigned int& edge, const char& type, std::vector<char>& marks, std::vector<unsigned int>& edges)
     {
-        partition();
-        preprocess();
+        if ( marks[edge] & type) return;
+        marks[edge] |= type;
+        edges.push_back( edge);
     }
 
-    void getBoundaryNodes( std::vector<NodeIterator>& boundary, const unsigned int& cell)
+    /**
+     * @brief One-to-all Pareto search from root on the reverse graph, or on the forward graph, given by the offsets
+     * of the edges of every node, their adjacent nodes and their ids. The bags of the touched nodes are reset first
+     *
+     * @return The number of labels settled
+     */
+    unsigned int paretoSearch( const unsigned int& root, const std::vector<unsigned int>& offset, const std::vector<unsigned int>& adjacent,
+                               const std::vector<unsigned int>& edges, std::vector<ParetoBag>& bags, PriorityQueueType& queue,
+                               std::vector<unsigned int>& touched) const
     {
-        NodeIterator u, lastNode;
-        boundary.clear();
-        unsigned int sum = 0;
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        unsigned int generatedLabels = 0;
+        for ( unsigned int j = 0; j < touched.size(); ++j)
+        {
+            bags[touched[j]].clear();
+        }
+        touched.clear();
+        queue.clear();
+
+        CriteriaList zero( m_numCriteria);
+        bags[root].insert( zero);
+        touched.push_back( root);
+        queue.insert( zero, root);
+        while ( !queue.empty())
         {
-            if( m_partition.getCell( u->x, u->y) != cell) continue;
-            sum++;
-            if( isBoundaryNodeInCell( u, cell)) boundary.push_back(u);
+            CriteriaList g_v = queue.minKey();
+            unsigned int v = queue.minItem();
+            queue.popMin();
+            if ( !( bags[v].contains( g_v))) continue;
+            ++generatedLabels;
+            for ( unsigned int i = offset[v]; i < offset[v + 1]; ++i)
+            {
+                unsigned int u = adjacent[i];
+                CriteriaList g_u = g_v + m_cost[edges[i]];
+                if ( bags[u].empty()) touched.push_back( u);
+                if ( bags[u].insert( g_u))
+                {
+                    queue.insert( g_u, u);
+                }
+            }
         }
-        std::cout << "\thas " << sum << " nodes\n";
+        return generatedLabels;
     }
+};
 
-    Partition& getPartition()
-    {
-        return m_partition;
-    } 
+/**
+ * @class NamoaStarArc
+ *
+ * @brief NAMOA*dr (see NamoaStarDR) restricted to the edges flagged for the cell of the target (see MulticriteriaArc)
+ *
+ * The flags are computed on the first query, or loaded from ARC_FLAGS_FILE when it holds the flags of the same graph.
+ * Otherwise they are written to it once computed.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class NamoaStarArc
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::NodeData        NodeData;
 
-    const unsigned int& getGeneratedLabels()
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+    typedef typename PriorityQueueType::PQItem PQItem;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    NamoaStarArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph),
+                        m_arcFlags( new MulticriteriaArc<GraphType>( graph, numCriteria, timestamp))
     {
-        return m_generatedLabels;
+        assert( m_numCriteria >= 2);
     }
 
-    void init(const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
-	{
-		typename GraphType::NodeIterator u, lastNode;
-		for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
-		    u->labels.clear();
-		}
-		pq.clear();
-	}   
-
-    bool isBoundaryNodeInCell( typename GraphType::NodeIterator& u, const unsigned int& cell)
-	{
-		std::vector<NodeDescriptor> neighbors = getNeighbors( G, u);
-		for( unsigned int i = 0; i < neighbors.size(); ++i)
-		{
-            NodeIterator v = G.getNodeIterator( neighbors[i]);
-            //std::cout << "(" << v->x << "," << v->y << ") (" << u->x << "," << u->y << ")\n";
-            //assert( m_partition.getCell( v->x, v->y) == cell);
-			if ( m_partition.getCell( v->x, v->y) != cell )
-				return true;
-     	}
-        return false;
-	}
-
-    void openFlagsLeadingTo( const std::vector< NodeIterator>& boundary, const unsigned int& cell)
-    {
-        NodeIterator u,v,lastNode;
-		EdgeIterator e,lastEdge;
-        InEdgeIterator k,lastInEdge;
-
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
-		    u->labels.clear();
-		}
-		PriorityQueueType queue;
-        unsigned int onMask = m_partition.getOnMask( cell);
+    /**
+     * @brief Sets the approximation factor used to prune with the solutions (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
 
-		bool isDominated;
+    /**
+     * @brief Sets the size of the partition used by the arc flags (see MulticriteriaArc::setPartitionSize)
+     */
+    void setPartitionSize( const unsigned int& numCells, const unsigned int& numLevels)
+    {
+        m_arcFlags->setPartitionSize( numCells, numLevels);
+    }
 
-        m_generatedLabels = boundary.size();
+    /**
+     * @brief Changes the criteria of some edges and repairs the flags (see MulticriteriaArc::updateWeights). The
+     * repaired flags replace ARC_FLAGS_FILE
+     */
+    void updateWeights( const std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+    {
+        if ( ( m_arcFlags->updateWeights( changes) > 0) && !( ARC_FLAGS_FILE.empty())) m_arcFlags->save( ARC_FLAGS_FILE);
+    }
 
-        for( unsigned int i = 0; i < boundary.size(); ++i)
+    /**
+     * @brief Computes the flags, or loads them from ARC_FLAGS_FILE, unless they are known
+     */
+    void loadOrPreprocess()
+    {
+        if ( !( m_arcFlags->isPreprocessed()) && ( ARC_FLAGS_FILE.empty() || !( m_arcFlags->load( ARC_FLAGS_FILE))))
         {
-            queue.insert( Label( CriteriaList(m_numCriteria), 0, boundary[i]->getDescriptor()), boundary[i]);
+            m_arcFlags->preprocess();
+            if ( !( ARC_FLAGS_FILE.empty())) m_arcFlags->save( ARC_FLAGS_FILE);
         }
+    }
 
-        std::cout << "\tBuilding boundary tree for cell " << cell << "\n";
-
-		while( !queue.empty())
-		{
-		    Label label = queue.min().key;
-		    u = queue.minItem();
-		    queue.popMin();
-
-		    for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
-		    {
-		        isDominated = false;
-		        v = G.source(k);
-
-                if( m_partition.getCell( v->x, v->y) == cell ) continue;
-
-		        Label newLabel( label.getCriteriaList() + k->criteriaList, u->getDescriptor(), label.getPredecessor() );
+    /**
+     * @brief Uses the flags of another object, run on a graph with the same edges, instead of its own
+     */
+    void sharePreprocessing( const NamoaStarArc& other)
+    {
+        m_arcFlags = other.m_arcFlags;
+    }
 
-		        for ( std::vector<Label>::iterator it = v->labels.begin(); it != v->labels.end(); ++it)
-		        {
-		            if ( it->dominatesUnique(newLabel) )
-		            {
-		                isDominated = true;
-		                break;
-		            }
-		        }
-		        if ( isDominated )  continue;
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        loadOrPreprocess();
+        NodeIterator u, lastNode;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            u->g_op.clear();
+            u->g_cl.clear();
+            u->clFront.clear();
+            u->heuristicSet.clear();
+        }
+        m_heuristicEngine.init( s, t, nCriteria);
+        pq.clear();
+    }
 
-                ++m_generatedLabels;
-		        queue.insert( newLabel, v);
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
 
-		        std::vector<Label>::iterator it = v->labels.begin();
-		        while ( it != v->labels.end() )
-		        {
-		            if ( it->isDominatedUniqueBy(newLabel) )
-		            {
-		                it = v->labels.erase( it );
-		            }
-		            else 
-		            {
-		                ++it;
-		            }
-		        }
+        m_generatedLabels = 0;
+        ++(*m_timestamp);
 
-		        v->labels.push_back( newLabel );
-		    }
-		}
+        s->g_op.push_back(Label( CriteriaList(m_numCriteria), 0, 0));
+        pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s, &(s->pqitem));
 
-        std::cout << "\tSetting flags out of cell " << cell << "\n";
+        while( !pq.empty())
+        {
+            CriteriaList f_u = pq.min().key;
+            u = pq.minItem();
+            pq.popMin();
+            CriteriaList g_u = f_u - u->heuristicList;
+            ++m_generatedLabels;
 
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
-            for ( std::vector<Label>::iterator it = u->labels.begin(); it != u->labels.end(); ++it)
-		    {   
-                e = G.getEdgeIterator( G.getNodeDescriptor(u), (NodeDescriptor)it->getPredecessor());
-                k = G.getInEdgeIterator( e);
-                e->flags |= onMask;
-                k->flags |= onMask;
+            if ( ( u == t) && t->clFront.dominates( g_u.inflate( m_epsilon)))
+            {
+                u->g_op.erase( u->g_op.begin());
             }
-            u->labels.clear();
-        }
-
-        std::cout << "\tSetting flags inside cell " << cell << "\n";
-
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
+            else
+            {
+                moveToClosed( g_u, u);
+            }
+            if ( !( u->g_op.empty()))
+            {
+                pq.insert( u->g_op.front().getCriteriaList() + u->heuristicList, u, &(u->pqitem));
+            }
+            if ( ( u == t) || isDominatedBySolutions( t, g_u + u->heuristicList))
+            {
+                continue;
+            }
+            unsigned int bit = m_arcFlags->getFlagBit( u, t);
             for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-		    {
+            {
+                if ( !( m_arcFlags->isFlagged( e, bit))) continue;
+
                 v = G.target(e);
-                if( m_partition.getCell( v->x, v->y) == cell )
+                CriteriaList g_v = g_u + e->criteriaList;
+                CriteriaList f_v = g_v + v->heuristicList;
+
+                if ( isDominatedBySolutions( t, f_v) || v->clFront.dominates( g_v))
                 {
-                    k = G.getInEdgeIterator( e);
-                    e->flags |= onMask;
-                    k->flags |= onMask;
+                    continue;
+                }
+                const bool wasEmpty = v->g_op.empty();
+                CriteriaList first;
+                if ( !wasEmpty)
+                {
+                    first = v->g_op.front().getCriteriaList();
+                }
+                if ( !( insertOpen( v, u, g_v)))
+                {
+                    continue;
+                }
+                if ( wasEmpty)
+                {
+                    pq.insert( f_v, v, &(v->pqitem));
+                }
+                else if ( !( v->g_op.front().getCriteriaList() == first))
+                {
+                    pq.decrease( f_v, &(v->pqitem));
                 }
             }
-		}
-        std::cout << "\tGenerated labels: " << m_generatedLabels << "\n";
+        }
     }
 
-    void partition()
+    const unsigned int& getGeneratedLabels()
     {
-        std::cout << "Partitioning graph...\n";
-        unsigned int xmax = 0, xmin = std::numeric_limits<unsigned int>::max(), ymax = 0, ymin = std::numeric_limits<unsigned int>::max();
-        NodeIterator u, v, last;
-        EdgeIterator e, lastEdge;
-        InEdgeIterator k;
-        for ( u = G.beginNodes(), last = G.endNodes(); u != last; ++u)
-        {
-            //for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-            //{
-            //    k = G.getInEdgeIterator(e);
-                //e->flags &= 0;
-                //k->flags &= 0;
-            //}
-            if ( u->x > xmax) xmax = u->x;
-            if ( u->x < xmin) xmin = u->x;
-            if ( u->y > ymax) ymax = u->y;
-            if ( u->y < ymin) ymin = u->y;
-        }
-        m_partition.reset( xmin, xmax, ymin, ymax, 4);
-        
+        return m_generatedLabels;
     }
 
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_generatedLabels;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    std::shared_ptr< MulticriteriaArc<GraphType> > m_arcFlags;
+    std::vector<double> m_epsilon;
 
-    void preprocess()
+    void moveToClosed( const CriteriaList& g_u, const NodeIterator& u)
     {
-        NodeIterator u, v, lastNode;
-        EdgeIterator e, lastEdge;
-        std::cout << "Preprocessing Arc Flags...\n";
-        for( unsigned int c = 0; c < m_partition.getNumCells(); ++c)
+        u->g_cl.push_back( Label( g_u, u->getDescriptor(), 0));
+        u->clFront.insert( g_u);
+        if ( !(u->g_op.empty()))
         {
-            std::cout << "Cell: " << c << "\n";
-            std::vector< NodeIterator> boundary;
-            getBoundaryNodes( boundary, c);
-            std::cout << "\thas " << boundary.size() << " boundary nodes\n";
-            openFlagsLeadingTo( boundary, c);
+            u->g_op.erase( u->g_op.begin());
         }
+    }
 
-        std::ofstream out("arc-flags");
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-		{
-            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-		    {
-                v = G.target(e);
-                out << G.getRelativePosition(u) + 1 << " " << G.getRelativePosition(v) + 1 << " " << e->flags << "\n";
-            }
-        }
-        out.close();
+    bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& f_v)
+    {
+        return !( t->clFront.empty()) && t->clFront.dominates( f_v.inflate( m_epsilon));
     }
 
-    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    /**
+     * @brief Inserts g_v in G_op(v) in lexicographic order (see NamoaStarDR::insertOpen)
+     */
+    bool insertOpen( const NodeIterator& v, const NodeIterator& u, const CriteriaList& g_v)
     {
-		NodeIterator u,v,lastNode;
-		EdgeIterator e,lastEdge;
-
-        unsigned int mask = m_partition.getOnMask( m_partition.getCell( t->x, t->y));
-
-		bool isDominated;
-
-        m_generatedLabels = 1;
-		pq.insert( Label( CriteriaList(m_numCriteria), 0, 0), s);
-
-		while( !pq.empty())
-		{
-		    Label label = pq.min().key;
-		    u = pq.minItem();
-		    pq.popMin();
-
-		    for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-		    {
-                if( ! (e->flags & mask)) continue;
-
-		        isDominated = false;
-		        v = G.target(e);
-		        Label newLabel( label.getCriteriaList() + e->criteriaList, u->getDescriptor(), 0 );
-
-		        for ( std::vector<Label>::iterator it = v->labels.begin(); it != v->labels.end(); ++it)
-		        {
-		            if ( it->dominates(newLabel) )
-		            {
-		                isDominated = true;
-		                break;
-		            }
-		        }
-		        if ( isDominated )  continue;
-
-                ++m_generatedLabels;
-		        pq.insert( newLabel, v);
-
-		        std::vector<Label>::iterator it = v->labels.begin();
-		        while ( it != v->labels.end() )
-		        {
-		            if ( it->isDominatedBy(newLabel) )
-		            {
-		                it = v->labels.erase( it );
-		            }
-		            else 
-		            {
-		                ++it;
-		            }
-		        }
-
-		        v->labels.push_back( newLabel );
-		    }
-		}
+        std::vector<Label>& g_op = v->g_op;
+        std::vector<Label>::iterator position = g_op.end();
+        for ( std::vector<Label>::iterator it = g_op.begin(); it != g_op.end(); ++it)
+        {
+            if ( it->getCriteriaList().dominates( g_v))
+            {
+                return false;
+            }
+            if ( position == g_op.end() && g_v < it->getCriteriaList())
+            {
+                position = it;
+            }
+        }
+        unsigned int index = position - g_op.begin();
+        std::vector<Label>::iterator last = g_op.begin() + index;
+        for ( std::vector<Label>::iterator it = last; it != g_op.end(); ++it)
+        {
+            if ( !( it->getCriteriaList().isDominatedBy( g_v))) *last++ = *it;
+        }
+        g_op.erase( last, g_op.end());
+        g_op.insert( g_op.begin() + index, Label( g_v, u->getDescriptor(), 0));
+        return true;
     }
-private:
-    GraphType& G;
-    PriorityQueueType pq;
-    unsigned int m_generatedLabels;
-	unsigned int m_numCriteria;
-	unsigned int* m_timestamp;
-    Partition m_partition;
 };
 
-#endif//MULTICRITERIAARC_H
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+void loadOrPreprocess( NamoaStarArc<GraphType, HeuristicGraphType>& algorithm)
+{
+    algorithm.loadOrPreprocess();
+}
+
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+void sharePreprocessing( NamoaStarArc<GraphType, HeuristicGraphType>& from, NamoaStarArc<GraphType, HeuristicGraphType>& to)
+{
+    to.sharePreprocessing( from);
+}
 
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+bool repairPreprocessing( NamoaStarArc<GraphType, HeuristicGraphType>& algorithm,
+                          const std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+{
+    algorithm.updateWeights( changes);
+    return true;
+}
+
+#endif//MULTICRITERIAARC_H
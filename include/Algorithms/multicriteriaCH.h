@@ -0,0 +1,671 @@
+#ifndef MULTICRITERIACH_H
+#define MULTICRITERIACH_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/multicriteriaGraph.h>
+#include <Utilities/preprocessingIO.h>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+
+static std::string CH_FILE;  // binary file caching the hierarchy between runs (empty: not cached)
+
+/**
+ * @class MulticriteriaCH
+ *
+ * @brief Multicriteria Contraction Hierarchies. Implementation for graphs with edges labeled with multiple criteria
+ *
+ * The preprocessing contracts the nodes in order of importance: a node v is removed from the graph, and for every
+ * pair of edges (u,v),(v,w) a shortcut (u,w) with the sum of their costs is added unless a witness search from u,
+ * that avoids v, finds a path to w that dominates it. Witness searches are bounded; when the bound is reached the
+ * remaining shortcuts are added, which is always correct. Several shortcuts may join the same pair of nodes, one per
+ * Pareto efficient cost. Every shortcut keeps the two edges it replaces, so paths can be unpacked.
+ *
+ * The importance of a node is the number of shortcuts its contraction adds minus the number of edges it removes,
+ * plus the number of neighbours already contracted. It is updated lazily. When the node with the smallest importance
+ * has too many edges the contraction stops, and the remaining nodes form the core of the hierarchy.
+ *
+ * A query runs a forward search from s on the edges leading to more important nodes (and on the core) and a backward
+ * search from t on the edges coming from more important nodes (and on the core). Both are one-to-all Pareto searches,
+ * and the solutions are the Pareto efficient combinations of the labels of the nodes reached by both.
+ *
+ * The hierarchy is built on the first query, or loaded from CH_FILE when it holds the hierarchy of the same graph.
+ * Otherwise it is written to it once built. It is only read by the queries, so several objects can share it (see
+ * sharePreprocessing).
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class MulticriteriaCH
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef PriorityQueue< CriteriaList, unsigned int, HeapStorage> PriorityQueueType;
+
+    /**
+     * @brief An edge of the hierarchy. Shortcuts keep the ids of the two edges they replace, original edges keep -1
+     */
+    struct HierarchyEdge
+    {
+        unsigned int source, target;
+        CriteriaList cost;
+        int first, second;
+    };
+
+    /**
+     * @brief The edges of the hierarchy and the order of the nodes, indexed by id
+     */
+    struct Hierarchy
+    {
+        std::vector<HierarchyEdge> edges;
+        std::vector<unsigned int> rank;
+        std::vector< std::vector<unsigned int> > up, down;  // edges leading to / coming from more important nodes
+        unsigned int coreSize;
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    MulticriteriaCH( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_preprocessed(false),
+                        m_witnessLimit(500), m_maxCoreDegree(64), m_hierarchy( new Hierarchy())
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_numNodes = maxId + 1;
+        m_forward.assign( m_numNodes, ParetoBag( numCriteria));
+        m_backward.assign( m_numNodes, ParetoBag( numCriteria));
+    }
+
+    /**
+     * @brief Sets the maximum number of labels settled by a witness search
+     */
+    void setWitnessLimit( const unsigned int& limit)
+    {
+        m_witnessLimit = limit;
+    }
+
+    /**
+     * @brief Sets the number of edges of a node above which the contraction stops and the core is left
+     */
+    void setMaxCoreDegree( const unsigned int& degree)
+    {
+        m_maxCoreDegree = degree;
+    }
+
+    /**
+     * @brief The solutions of a query are thinned out to a (1+epsilon)-covering subset (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    /**
+     * @brief Builds the hierarchy
+     */
+    void preprocess()
+    {
+        NodeIterator u,lastNode;
+        EdgeIterator e,lastEdge;
+
+        m_hierarchy.reset( new Hierarchy());
+        m_out.assign( m_numNodes, std::vector<unsigned int>());
+        m_in.assign( m_numNodes, std::vector<unsigned int>());
+        m_hierarchy->up.assign( m_numNodes, std::vector<unsigned int>());
+        m_hierarchy->down.assign( m_numNodes, std::vector<unsigned int>());
+        m_hierarchy->rank.assign( m_numNodes, 0);
+        m_contracted.assign( m_numNodes, false);
+        m_witnessBags.assign( m_numNodes, ParetoBag( m_numCriteria));
+        std::vector<unsigned int> contractedNeighbours( m_numNodes, 0);
+        std::vector<bool> exists( m_numNodes, false);
+
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            exists[u->id] = true;
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                if ( G.target(e)->id == u->id) continue;
+                addEdge( u->id, G.target(e)->id, e->criteriaList, -1, -1);
+            }
+        }
+
+        typedef std::pair<int, unsigned int> Importance;
+        std::priority_queue< Importance, std::vector<Importance>, std::greater<Importance> > order;
+        std::vector< std::pair<unsigned int, unsigned int> > shortcuts;
+        for ( unsigned int v = 0; v < m_numNodes; ++v)
+        {
+            if ( !exists[v]) continue;
+            findShortcuts( v, shortcuts);
+            order.push( Importance( importance( v, shortcuts, contractedNeighbours), v));
+        }
+
+        unsigned int rank = 0;
+        while ( !order.empty())
+        {
+            unsigned int v = order.top().second;
+            order.pop();
+            if ( m_contracted[v]) continue;
+            findShortcuts( v, shortcuts);
+            int priority = importance( v, shortcuts, contractedNeighbours);
+            if ( !order.empty() && priority > order.top().first)
+            {
+                order.push( Importance( priority, v));
+                continue;
+            }
+            if ( m_out[v].size() + m_in[v].size() > m_maxCoreDegree)
+            {
+                break;
+            }
+            contract( v, shortcuts, contractedNeighbours);
+            m_hierarchy->rank[v] = rank++;
+        }
+
+        // the nodes left form the core, where every edge is searched in both directions
+        m_hierarchy->coreSize = 0;
+        for ( unsigned int v = 0; v < m_numNodes; ++v)
+        {
+            if ( !exists[v] || m_contracted[v]) continue;
+            ++m_hierarchy->coreSize;
+            m_hierarchy->rank[v] = rank;
+            freeze( v);
+        }
+        m_out.clear();
+        m_in.clear();
+        m_witnessBags.clear();
+        m_contracted.clear();
+        m_preprocessed = true;
+    }
+
+    /**
+     * @brief Builds the hierarchy, or loads it from CH_FILE, unless it is known
+     */
+    void loadOrPreprocess()
+    {
+        if ( !m_preprocessed && ( CH_FILE.empty() || !load( CH_FILE)))
+        {
+            preprocess();
+            if ( !( CH_FILE.empty())) save( CH_FILE);
+        }
+    }
+
+    /**
+     * @brief Uses the hierarchy of another object, run on a graph with the same nodes, instead of its own
+     */
+    void sharePreprocessing( const MulticriteriaCH& other)
+    {
+        m_hierarchy = other.m_hierarchy;
+        m_preprocessed = other.m_preprocessed;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        assert( nCriteria == m_numCriteria);
+        loadOrPreprocess();
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        ++(*m_timestamp);
+        m_generatedLabels = 0;
+        // the backward search goes first, so the forward one can combine and prune with the solutions on the fly
+        ParetoBag solutions( m_numCriteria);
+        upwardSearch( t->id, m_hierarchy->down, false, m_backward, m_backwardTouched, 0);
+        upwardSearch( s->id, m_hierarchy->up, true, m_forward, m_forwardTouched, &solutions);
+
+        t->g_cl.clear();
+        for ( unsigned int i = 0; i < solutions.size(); ++i)
+        {
+            CriteriaList g = solutions.get( i);
+            if ( !m_epsilon.empty() && isApproximatedBy( t->g_cl, g)) continue;
+            t->g_cl.push_back( Label( g, t->getDescriptor(), 0));
+        }
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+    unsigned int getNumEdges() const
+    {
+        return m_hierarchy->edges.size();
+    }
+
+    unsigned int getCoreSize() const
+    {
+        return m_hierarchy->coreSize;
+    }
+
+    const HierarchyEdge& getEdge( const unsigned int& edgeId) const
+    {
+        return m_hierarchy->edges[edgeId];
+    }
+
+    /**
+     * @brief Appends to path the ids of the nodes of the original path represented by an edge, but its source
+     */
+    void unpack( const unsigned int& edgeId, std::vector<unsigned int>& path) const
+    {
+        const HierarchyEdge& edge = m_hierarchy->edges[edgeId];
+        if ( edge.first < 0)
+        {
+            path.push_back( edge.target);
+            return;
+        }
+        unpack( edge.first, path);
+        unpack( edge.second, path);
+    }
+
+    /**
+     * @brief Writes the hierarchy to a binary file
+     */
+    void save( const std::string& filename) const
+    {
+        assert( m_preprocessed);
+        std::ofstream out( filename.c_str(), std::ios::binary);
+        unsigned long long checksum = getGraphChecksum( G, m_numCriteria);
+        writeValue( out, m_numNodes);
+        writeValue( out, m_numCriteria);
+        writeValue( out, checksum);
+        writeValue( out, m_hierarchy->coreSize);
+        writeValue( out, (unsigned int) m_hierarchy->edges.size());
+        for ( unsigned int i = 0; i < m_hierarchy->edges.size(); ++i)
+        {
+            writeValue( out, m_hierarchy->edges[i].source);
+            writeValue( out, m_hierarchy->edges[i].target);
+            writeValue( out, m_hierarchy->edges[i].first);
+            writeValue( out, m_hierarchy->edges[i].second);
+            for ( unsigned int j = 0; j < m_numCriteria; ++j)
+            {
+                writeValue( out, m_hierarchy->edges[i].cost[j]);
+            }
+        }
+        for ( unsigned int v = 0; v < m_numNodes; ++v)
+        {
+            writeValue( out, m_hierarchy->rank[v]);
+            writeList( out, m_hierarchy->up[v]);
+            writeList( out, m_hierarchy->down[v]);
+        }
+    }
+
+    /**
+     * @brief Reads a hierarchy written by save
+     *
+     * @return False if the file does not exist or it was written for another graph, or for other costs
+     */
+    bool load( const std::string& filename)
+    {
+        std::ifstream in( filename.c_str(), std::ios::binary);
+        if ( !in.good()) return false;
+        unsigned int numNodes, numCriteria, numEdges;
+        unsigned long long checksum;
+        readValue( in, numNodes);
+        readValue( in, numCriteria);
+        readValue( in, checksum);
+        if ( !in.good() || numNodes != m_numNodes || numCriteria != m_numCriteria || checksum != getGraphChecksum( G, m_numCriteria))
+        {
+            return false;
+        }
+        m_hierarchy.reset( new Hierarchy());
+        readValue( in, m_hierarchy->coreSize);
+        readValue( in, numEdges);
+        if ( !in.good()) return false;
+        m_hierarchy->edges.resize( numEdges);
+        for ( unsigned int i = 0; i < numEdges; ++i)
+        {
+            readValue( in, m_hierarchy->edges[i].source);
+            readValue( in, m_hierarchy->edges[i].target);
+            readValue( in, m_hierarchy->edges[i].first);
+            readValue( in, m_hierarchy->edges[i].second);
+            m_hierarchy->edges[i].cost = CriteriaList( m_numCriteria);
+            for ( unsigned int j = 0; j < m_numCriteria; ++j)
+            {
+                readValue( in, m_hierarchy->edges[i].cost[j]);
+            }
+        }
+        m_hierarchy->rank.resize( m_numNodes);
+        m_hierarchy->up.resize( m_numNodes);
+        m_hierarchy->down.resize( m_numNodes);
+        for ( unsigned int v = 0; v < m_numNodes; ++v)
+        {
+            readValue( in, m_hierarchy->rank[v]);
+            readList( in, m_hierarchy->up[v]);
+            readList( in, m_hierarchy->down[v]);
+        }
+        m_preprocessed = in.good();
+        if ( !m_preprocessed) m_hierarchy->edges.clear();
+        return m_preprocessed;
+    }
+
+private:
+    GraphType& G;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    unsigned int m_numNodes;
+    bool m_preprocessed;
+    unsigned int m_witnessLimit;
+    unsigned int m_maxCoreDegree;
+    unsigned int m_generatedLabels;
+    PriorityQueueType pq;
+    std::vector<double> m_epsilon;
+
+    std::shared_ptr<Hierarchy> m_hierarchy;
+
+    // contraction state
+    std::vector< std::vector<unsigned int> > m_out, m_in;
+    std::vector<bool> m_contracted;
+    std::vector<ParetoBag> m_witnessBags;
+    std::vector<unsigned int> m_witnessTouched;
+
+    // query state
+    std::vector<ParetoBag> m_forward, m_backward;
+    std::vector<unsigned int> m_forwardTouched, m_backwardTouched;
+
+    void addEdge( const unsigned int& source, const unsigned int& target, const CriteriaList& cost, int first, int second)
+    {
+        HierarchyEdge edge;
+        edge.source = source;
+        edge.target = target;
+        edge.cost = cost;
+        edge.first = first;
+        edge.second = second;
+        m_out[source].push_back( m_hierarchy->edges.size());
+        m_in[target].push_back( m_hierarchy->edges.size());
+        m_hierarchy->edges.push_back( edge);
+    }
+
+    int importance( const unsigned int& v, const std::vector< std::pair<unsigned int, unsigned int> >& shortcuts,
+                    const std::vector<unsigned int>& contractedNeighbours) const
+    {
+        return (int) shortcuts.size() - (int) ( m_out[v].size() + m_in[v].size()) + (int) contractedNeighbours[v];
+    }
+
+    /**
+     * @brief Computes the pairs of edges (u,v),(v,w) that need a shortcut when v is contracted
+     */
+    void findShortcuts( const unsigned int& v, std::vector< std::pair<unsigned int, unsigned int> >& shortcuts)
+    {
+        shortcuts.clear();
+        std::vector<unsigned int> incoming( m_in[v]);
+        std::sort( incoming.begin(), incoming.end(), [this]( unsigned int a, unsigned int b)
+        {
+            return m_hierarchy->edges[a].source < m_hierarchy->edges[b].source;
+        });
+        std::vector< std::pair<unsigned int, unsigned int> > pairs;
+        std::vector<CriteriaList> costs;
+        for ( unsigned int i = 0; i < incoming.size(); )
+        {
+            unsigned int u = m_hierarchy->edges[incoming[i]].source;
+            pairs.clear();
+            costs.clear();
+            for ( ; i < incoming.size() && m_hierarchy->edges[incoming[i]].source == u; ++i)
+            {
+                for ( unsigned int j = 0; j < m_out[v].size(); ++j)
+                {
+                    const HierarchyEdge& outgoing = m_hierarchy->edges[m_out[v][j]];
+                    if ( outgoing.target == u) continue;
+                    pairs.push_back( std::make_pair( incoming[i], m_out[v][j]));
+                    costs.push_back( m_hierarchy->edges[incoming[i]].cost + outgoing.cost);
+                }
+            }
+            if ( pairs.empty()) continue;
+            witnessSearch( u, v, costs);
+            for ( unsigned int k = 0; k < pairs.size(); ++k)
+            {
+                unsigned int w = m_hierarchy->edges[pairs[k].second].target;
+                if ( m_witnessBags[w].isDominated( costs[k]) || isDominatedByCandidate( w, k, pairs, costs))
+                {
+                    continue;
+                }
+                shortcuts.push_back( pairs[k]);
+            }
+        }
+    }
+
+    /**
+     * @brief A candidate is not needed if another candidate to the same node dominates it (ties keep the first one)
+     */
+    bool isDominatedByCandidate( const unsigned int& w, const unsigned int& k,
+                                 const std::vector< std::pair<unsigned int, unsigned int> >& pairs,
+                                 const std::vector<CriteriaList>& costs) const
+    {
+        for ( unsigned int i = 0; i < pairs.size(); ++i)
+        {
+            if ( i == k || m_hierarchy->edges[pairs[i].second].target != w) continue;
+            if ( costs[i] == costs[k])
+            {
+                if ( i < k) return true;
+            }
+            else if ( costs[i].dominates( costs[k]))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Bounded Pareto search from u that avoids v. Only labels that may dominate a candidate are kept
+     */
+    void witnessSearch( const unsigned int& u, const unsigned int& v, const std::vector<CriteriaList>& costs)
+    {
+        for ( unsigned int i = 0; i < m_witnessTouched.size(); ++i)
+        {
+            m_witnessBags[m_witnessTouched[i]].clear();
+        }
+        m_witnessTouched.clear();
+        pq.clear();
+
+        CriteriaList zero( m_numCriteria);
+        witnessBag( u).insert( zero);
+        pq.insert( zero, u);
+        unsigned int settled = 0;
+        while ( !pq.empty() && settled < m_witnessLimit)
+        {
+            CriteriaList g_x = pq.minKey();
+            unsigned int x = pq.minItem();
+            pq.popMin();
+            if ( !( m_witnessBags[x].contains( g_x))) continue;
+            ++settled;
+            for ( unsigned int i = 0; i < m_out[x].size(); ++i)
+            {
+                const HierarchyEdge& edge = m_hierarchy->edges[m_out[x][i]];
+                if ( edge.target == v) continue;
+                CriteriaList g_y = g_x + edge.cost;
+                if ( !isUseful( g_y, costs)) continue;
+                if ( witnessBag( edge.target).insert( g_y))
+                {
+                    pq.insert( g_y, edge.target);
+                }
+            }
+        }
+        pq.clear();
+    }
+
+    ParetoBag& witnessBag( const unsigned int& x)
+    {
+        if ( m_witnessBags[x].empty()) m_witnessTouched.push_back( x);
+        return m_witnessBags[x];
+    }
+
+    /**
+     * @brief A witness label is only useful if it is not worse than some candidate in every criterion
+     */
+    bool isUseful( const CriteriaList& g, const std::vector<CriteriaList>& costs) const
+    {
+        for ( unsigned int i = 0; i < costs.size(); ++i)
+        {
+            if ( g.dominates( costs[i])) return true;
+        }
+        return false;
+    }
+
+    void contract( const unsigned int& v, const std::vector< std::pair<unsigned int, unsigned int> >& shortcuts,
+                   std::vector<unsigned int>& contractedNeighbours)
+    {
+        freeze( v);
+        m_contracted[v] = true;
+        for ( unsigned int i = 0; i < shortcuts.size(); ++i)
+        {
+            const HierarchyEdge& first = m_hierarchy->edges[shortcuts[i].first];
+            const HierarchyEdge& second = m_hierarchy->edges[shortcuts[i].second];
+            unsigned int u = first.source, w = second.target;
+            CriteriaList cost = first.cost + second.cost;
+            removeDominatedEdges( u, w, cost);
+            addEdge( u, w, cost, shortcuts[i].first, shortcuts[i].second);
+        }
+        // detach v from its neighbours
+        for ( unsigned int i = 0; i < m_in[v].size(); ++i)
+        {
+            unsigned int u = m_hierarchy->edges[m_in[v][i]].source;
+            ++contractedNeighbours[u];
+            eraseEdgesTo( m_out[u], v, true);
+        }
+        for ( unsigned int i = 0; i < m_out[v].size(); ++i)
+        {
+            unsigned int w = m_hierarchy->edges[m_out[v][i]].target;
+            ++contractedNeighbours[w];
+            eraseEdgesTo( m_in[w], v, false);
+        }
+        m_out[v].clear();
+        m_in[v].clear();
+    }
+
+    /**
+     * @brief Keeps the current edges of v between it and the nodes not contracted yet as its upward edges
+     */
+    void freeze( const unsigned int& v)
+    {
+        m_hierarchy->up[v].clear();
+        m_hierarchy->down[v].clear();
+        for ( unsigned int i = 0; i < m_out[v].size(); ++i)
+        {
+            if ( !m_contracted[m_hierarchy->edges[m_out[v][i]].target]) m_hierarchy->up[v].push_back( m_out[v][i]);
+        }
+        for ( unsigned int i = 0; i < m_in[v].size(); ++i)
+        {
+            if ( !m_contracted[m_hierarchy->edges[m_in[v][i]].source]) m_hierarchy->down[v].push_back( m_in[v][i]);
+        }
+    }
+
+    void eraseEdgesTo( std::vector<unsigned int>& edges, const unsigned int& v, const bool& byTarget)
+    {
+        unsigned int kept = 0;
+        for ( unsigned int i = 0; i < edges.size(); ++i)
+        {
+            const HierarchyEdge& edge = m_hierarchy->edges[edges[i]];
+            if ( ( byTarget ? edge.target : edge.source) == v) continue;
+            edges[kept++] = edges[i];
+        }
+        edges.resize( kept);
+    }
+
+    /**
+     * @brief Parallel edges dominated by a new shortcut are not needed anymore
+     */
+    void removeDominatedEdges( const unsigned int& u, const unsigned int& w, const CriteriaList& cost)
+    {
+        std::vector<unsigned int> dominated;
+        for ( unsigned int i = 0; i < m_out[u].size(); ++i)
+        {
+            const HierarchyEdge& edge = m_hierarchy->edges[m_out[u][i]];
+            if ( edge.target == w && cost.dominates( edge.cost)) dominated.push_back( m_out[u][i]);
+        }
+        for ( unsigned int i = 0; i < dominated.size(); ++i)
+        {
+            m_out[u].erase( std::find( m_out[u].begin(), m_out[u].end(), dominated[i]));
+            m_in[w].erase( std::find( m_in[w].begin(), m_in[w].end(), dominated[i]));
+        }
+    }
+
+    /**
+     * @brief Search on the upward (or downward) edges only. If solutions is given, the labels reaching a node of the
+     * backward search are combined with its labels, and the labels dominated by the solutions are pruned
+     */
+    void upwardSearch( const unsigned int& root, const std::vector< std::vector<unsigned int> >& edges, const bool& forward,
+                       std::vector<ParetoBag>& bags, std::vector<unsigned int>& touched, ParetoBag* solutions)
+    {
+        for ( unsigned int i = 0; i < touched.size(); ++i)
+        {
+            bags[touched[i]].clear();
+        }
+        touched.clear();
+        pq.clear();
+
+        CriteriaList zero( m_numCriteria);
+        bags[root].insert( zero);
+        touched.push_back( root);
+        pq.insert( zero, root);
+        while ( !pq.empty())
+        {
+            CriteriaList g_x = pq.minKey();
+            unsigned int x = pq.minItem();
+            pq.popMin();
+            if ( !( bags[x].contains( g_x))) continue;
+            if ( solutions != 0)
+            {
+                if ( solutions->isDominated( g_x)) continue;
+                const ParetoBag& backward = m_backward[x];
+                for ( unsigned int k = 0; k < backward.size(); ++k)
+                {
+                    solutions->insert( g_x + backward.get( k));
+                }
+            }
+            ++m_generatedLabels;
+            for ( unsigned int i = 0; i < edges[x].size(); ++i)
+            {
+                const HierarchyEdge& edge = m_hierarchy->edges[edges[x][i]];
+                unsigned int y = forward ? edge.target : edge.source;
+                CriteriaList g_y = g_x + edge.cost;
+                if ( solutions != 0 && solutions->isDominated( g_y)) continue;
+                if ( bags[y].empty()) touched.push_back( y);
+                if ( bags[y].insert( g_y))
+                {
+                    pq.insert( g_y, y);
+                }
+            }
+        }
+    }
+
+    bool isApproximatedBy( const std::vector<Label>& labels, const CriteriaList& g) const
+    {
+        for ( unsigned int i = 0; i < labels.size(); ++i)
+        {
+            if ( labels[i].getCriteriaList().epsilonDominates( g, m_epsilon)) return true;
+        }
+        return false;
+    }
+};
+
+template<class GraphType>
+void loadOrPreprocess( MulticriteriaCH<GraphType>& algorithm)
+{
+    algorithm.loadOrPreprocess();
+}
+
+template<class GraphType>
+void sharePreprocessing( MulticriteriaCH<GraphType>& from, MulticriteriaCH<GraphType>& to)
+{
+    to.sharePreprocessing( from);
+}
+
+#endif // MULTICRITERIACH_H
@@ -3,6 +3,7 @@
 
 #include <Structs/Trees/priorityQueue.h>
 #include <Structs/Graphs/nodeSelection.h>
+#include <Algorithms/multicriteriaGraph.h>
 
 /**
  * @class Dijkstra
@@ -350,5 +351,181 @@ private:
 
 
 
+/**
+ * @class MulticriteriaDijkstra
+ *
+ * @brief One-to-all multicriteria label-setting algorithm. Implementation for graphs with edges labeled with multiple criteria
+ *
+ * Computes the full set of Pareto efficient costs from a source node to every node of the graph. Tentative labels are
+ * kept in a ParetoBag per node, indexed by the node id, and in a priority queue ordered lexicographically. A label is
+ * settled when it is extracted and it is still in the bag of its node; otherwise a dominating label replaced it and
+ * the entry is skipped. Settled labels are never dominated later on, since every label found afterwards is
+ * lexicographically greater.
+ *
+ * It can also run a query between two nodes, using the bag of the target to prune the search.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class MulticriteriaDijkstra
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    MulticriteriaDijkstra( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_settledLabels(0)
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_bags.assign( maxId + 1, ParetoBag( numCriteria));
+    }
+
+    /**
+     * @brief Computes the Pareto efficient costs from a source node to every node of the graph
+     *
+     * @param s The source node
+     */
+    void buildTree( const typename GraphType::NodeIterator& s)
+    {
+        search( s, G.endNodes());
+    }
+
+    /**
+     * @brief Returns the labels of a node, in lexicographic order. After buildTree they are its Pareto efficient costs
+     */
+    const ParetoBag& getBag( const NodeIterator& u) const
+    {
+        return m_bags[u->id];
+    }
+
+    /**
+     * @brief Sets the approximation factor used to prune with the labels of the target (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        assert( nCriteria == m_numCriteria);
+        pq.clear();
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        search( s, t);
+        t->g_cl.clear();
+        m_bags[t->id].copyTo( t->g_cl, t->getDescriptor());
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_settledLabels;
+    }
+
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    unsigned int m_settledLabels;
+    std::vector<ParetoBag> m_bags;
+    std::vector<unsigned int> m_touched;
+    std::vector<double> m_epsilon;
+
+    ParetoBag& bag( const NodeIterator& u)
+    {
+        ParetoBag& b = m_bags[u->id];
+        if ( b.empty()) m_touched.push_back( u->id);
+        return b;
+    }
+
+    /**
+     * @brief Label-setting search from s. If t is a node of the graph, the labels dominated by the ones of t are pruned
+     */
+    void search( const NodeIterator& s, const NodeIterator& t)
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
+        const bool hasTarget = ( t != G.endNodes());
+
+        ++(*m_timestamp);
+        m_settledLabels = 0;
+        for ( unsigned int i = 0; i < m_touched.size(); ++i)
+        {
+            m_bags[m_touched[i]].clear();
+        }
+        m_touched.clear();
+        pq.clear();
+
+        CriteriaList zero( m_numCriteria);
+        bag( s).insert( zero);
+        pq.insert( zero, s);
+
+        while( !pq.empty())
+        {
+            CriteriaList g_u = pq.minKey();
+            u = pq.minItem();
+            pq.popMin();
+            if ( !( m_bags[u->id].contains( g_u)))
+            {
+                continue;
+            }
+            ++m_settledLabels;
+
+            if (DEBUG == 1) {
+                o_debug << "\nIT: " << m_settledLabels << "\nSettling |" << u->id << "| g: (";
+                g_u.print(o_debug, ", ");
+                o_debug << ")" << std::endl;
+            }
+
+            if ( hasTarget && ( u == t || isDominatedByTarget( t, g_u)))
+            {
+                continue;
+            }
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                CriteriaList g_v = g_u + e->criteriaList;
+                if ( hasTarget && ( v != t) && isDominatedByTarget( t, g_v))
+                {
+                    continue;
+                }
+                if ( bag( v).insert( g_v))
+                {
+                    pq.insert( g_v, v);
+                }
+            }
+        }
+    }
+
+    bool isDominatedByTarget( const NodeIterator& t, const CriteriaList& g_v)
+    {
+        return m_bags[t->id].isDominated( m_epsilon.empty() ? g_v : g_v.inflate( m_epsilon));
+    }
+};
+
 #endif//MULTICRITERIADIJKSTRA_H
 
@@ -2,6 +2,9 @@
 #define MULTICRITERIAGRAPH_H
 
 #include <Structs/Graphs/nodeSelection.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 static unsigned int NUM_CRITERIA = 2;
 
@@ -80,6 +83,28 @@ public:
         return other.dominates(*this);
     }
 
+    /**
+     * @brief Returns the largest vector that is (1+epsilon)-dominated by this one, i.e. floor((1+epsilon_i) * c_i).
+     * An empty epsilon leaves the vector unchanged
+     */
+    CriteriaList inflate(const std::vector<double>& epsilon) const
+    {
+        CriteriaList inflated( *this);
+        for ( unsigned int i = 0; i < epsilon.size() && i < m_criteria.size(); ++i)
+        {
+            inflated.m_criteria[i] = (WeightType) floor( (1 + epsilon[i]) * m_criteria[i]);
+        }
+        return inflated;
+    }
+
+    /**
+     * @brief Checks whether c_i <= (1+epsilon_i) * other_i holds for every criterion
+     */
+    bool epsilonDominates(const CriteriaList& other, const std::vector<double>& epsilon) const
+    {
+        return dominates( other.inflate( epsilon));
+    }
+
     WeightType& operator [] ( unsigned int pos)
     {
         assert ( 0 <= pos);
@@ -89,6 +114,12 @@ public:
         return *it;
     }
 
+    const WeightType& operator [] ( unsigned int pos) const
+    {
+        assert ( pos < m_criteria.size());
+        return m_criteria[pos];
+    }
+
     bool operator < (const CriteriaList& other) const
     {
         assert( m_criteria.size() == other.m_criteria.size());
@@ -159,6 +190,11 @@ public:
         return diff;
     }
 
+    unsigned int size() const
+    {
+        return m_criteria.size();
+    }
+
     void print (std::ostream& out, const std::string& delimiter = ", " )
     {
         for ( Iterator criterion = m_criteria.begin(), endCriterion = m_criteria.end(); criterion != endCriterion; ++criterion)
@@ -177,25 +213,27 @@ class Label
 {
 public:
 
-    Label(): m_criteriaList( 0), m_pred(0), m_data(0)
+    Label(): m_criteriaList( 0), m_pred(0), m_data(0), m_treeIndex(0)
     {
     }
 
-    Label( const unsigned int& numCriteria): m_criteriaList( numCriteria), m_pred(0), m_data(0)
+    Label( const unsigned int& numCriteria): m_criteriaList( numCriteria), m_pred(0), m_data(0), m_treeIndex(0)
     {
     }
 
-    Label( const CriteriaList& criteriaList, void* pred, void* data):
+    Label( const CriteriaList& criteriaList, void* pred, void* data, const unsigned int& treeIndex = 0):
                                                     m_criteriaList( criteriaList),
                                                     m_pred(pred),
-                                                    m_data(data)
+                                                    m_data(data),
+                                                    m_treeIndex(treeIndex)
     {
     }
 
     Label( const Label& other):
                         m_criteriaList( other.m_criteriaList),
                         m_pred(other.m_pred),
-                        m_data(other.m_data)
+                        m_data(other.m_data),
+                        m_treeIndex(other.m_treeIndex)
     {
     }
 
@@ -221,6 +259,14 @@ public:
         return m_pred;
     }
 
+    /**
+     * @brief Position of the label in the LabelTree of the query, if the algorithm keeps one
+     */
+    const unsigned int& getTreeIndex() const
+    {
+        return m_treeIndex;
+    }
+
     const CriteriaList& getCriteriaList() const
     {
         return m_criteriaList;
@@ -289,6 +335,371 @@ private:
     };
 
     extra_info m_data;
+    unsigned int m_treeIndex;
+};
+
+/**
+ * @class TruncatedFront
+ *
+ * @brief Pareto front of a set of cost vectors that ignores their first criterion
+ *
+ * It is only valid when the vectors are queried and inserted in lexicographic order: then the first criterion of a
+ * query is never smaller than the first criterion of the stored vectors and dominance can be decided on the k-1
+ * remaining criteria. For two criteria the front is a single value, for three criteria it is a staircase sorted by the
+ * second criterion (and decreasing on the third) searched by bisection, and for more criteria it is a plain list.
+ */
+class TruncatedFront
+{
+public:
+    typedef CriteriaList::WeightType WeightType;
+    typedef std::pair< WeightType, WeightType> Step;
+
+    TruncatedFront(): m_dimension(0)
+    {
+    }
+
+    void clear()
+    {
+        m_dimension = 0;
+        m_staircase.clear();
+        m_points.clear();
+    }
+
+    bool empty() const
+    {
+        return m_dimension == 0;
+    }
+
+    /**
+     * @brief Checks whether a vector, lexicographically not smaller than the stored ones, is dominated by the front
+     */
+    bool dominates( const CriteriaList& other) const
+    {
+        if ( empty()) return false;
+        assert( other.size() == m_dimension + 1);
+        switch ( m_dimension)
+        {
+            case 1:
+                return m_min <= other[1];
+            case 2:
+            {
+                // the last step whose second criterion is not greater has the smallest third criterion among them
+                std::vector<Step>::const_iterator it = std::upper_bound( m_staircase.begin(), m_staircase.end(), Step( other[1], std::numeric_limits<WeightType>::max()));
+                if ( it == m_staircase.begin()) return false;
+                --it;
+                return it->second <= other[2];
+            }
+            default:
+                for ( unsigned int i = 0; i < m_points.size(); i += m_dimension)
+                {
+                    unsigned int j = 0;
+                    while ( j < m_dimension && m_points[i + j] <= other[j + 1]) ++j;
+                    if ( j == m_dimension) return true;
+                }
+                return false;
+        }
+    }
+
+    /**
+     * @brief Inserts a vector that is not dominated by the front, removing the stored vectors it dominates
+     */
+    void insert( const CriteriaList& other)
+    {
+        if ( empty())
+        {
+            m_dimension = other.size() - 1;
+            m_min = std::numeric_limits<WeightType>::max();
+        }
+        assert( other.size() == m_dimension + 1);
+        switch ( m_dimension)
+        {
+            case 1:
+                m_min = std::min( m_min, other[1]);
+                break;
+            case 2:
+            {
+                Step step( other[1], other[2]);
+                std::vector<Step>::iterator first = std::lower_bound( m_staircase.begin(), m_staircase.end(), Step( step.first, 0));
+                std::vector<Step>::iterator last = first;
+                while ( last != m_staircase.end() && last->second >= step.second) ++last;
+                first = m_staircase.erase( first, last);
+                m_staircase.insert( first, step);
+                break;
+            }
+            default:
+            {
+                unsigned int kept = 0;
+                for ( unsigned int i = 0; i < m_points.size(); i += m_dimension)
+                {
+                    unsigned int j = 0;
+                    while ( j < m_dimension && other[j + 1] <= m_points[i + j]) ++j;
+                    if ( j == m_dimension) continue;
+                    std::copy( m_points.begin() + i, m_points.begin() + i + m_dimension, m_points.begin() + kept);
+                    kept += m_dimension;
+                }
+                m_points.resize( kept);
+                for ( unsigned int j = 1; j <= m_dimension; ++j)
+                {
+                    m_points.push_back( other[j]);
+                }
+            }
+        }
+    }
+
+private:
+    unsigned int m_dimension;
+    WeightType m_min;
+    std::vector<Step> m_staircase;
+    std::vector<WeightType> m_points;
+};
+
+/**
+ * @class ParetoBag
+ *
+ * @brief Set of mutually non-dominated cost vectors, stored in a single array in lexicographic order
+ *
+ * Only the vectors placed before a new vector can dominate it and only the ones placed after it can be dominated
+ * by it, so an insertion locates its position by bisection, scans the prefix and compacts the suffix in one pass.
+ * For two criteria the second criterion decreases along the bag, and both steps reduce to a bisection and the
+ * erasure of a contiguous range.
+ */
+class ParetoBag
+{
+public:
+    typedef CriteriaList::WeightType WeightType;
+
+    ParetoBag( const unsigned int& numCriteria = 0): m_numCriteria( numCriteria)
+    {
+    }
+
+    void clear()
+    {
+        m_values.clear();
+    }
+
+    bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    unsigned int size() const
+    {
+        return m_numCriteria ? m_values.size() / m_numCriteria : 0;
+    }
+
+    /**
+     * @brief Returns the i-th vector of the bag in lexicographic order
+     */
+    CriteriaList get( const unsigned int& i) const
+    {
+        return CriteriaList( std::vector<WeightType>( m_values.begin() + i * m_numCriteria, m_values.begin() + (i + 1) * m_numCriteria));
+    }
+
+    /**
+     * @brief Checks whether the vector is dominated by (or equal to) a vector of the bag
+     */
+    bool isDominated( const CriteriaList& other) const
+    {
+        return isDominated( other, position( other));
+    }
+
+    /**
+     * @brief Checks whether the vector is in the bag
+     */
+    bool contains( const CriteriaList& other) const
+    {
+        unsigned int pos = position( other);
+        return ( pos < size()) && ( compare( pos, other) == 0);
+    }
+
+    /**
+     * @brief Inserts the vector unless it is dominated, and removes the vectors it dominates
+     *
+     * @return True if the vector has been inserted
+     */
+    bool insert( const CriteriaList& other)
+    {
+        if ( m_numCriteria == 0) m_numCriteria = other.size();
+        assert( other.size() == m_numCriteria);
+        unsigned int pos = position( other);
+        if ( isDominated( other, pos))
+        {
+            return false;
+        }
+        unsigned int n = size();
+        unsigned int last = pos;
+        if ( m_numCriteria == 2)
+        {
+            while ( last < n && m_values[2 * last + 1] >= other[1]) ++last;
+            m_values.erase( m_values.begin() + 2 * pos, m_values.begin() + 2 * last);
+        }
+        else
+        {
+            for ( unsigned int i = pos; i < n; ++i)
+            {
+                if ( dominates( other, i)) continue;
+                if ( last != i)
+                {
+                    std::copy( m_values.begin() + i * m_numCriteria, m_values.begin() + (i + 1) * m_numCriteria, m_values.begin() + last * m_numCriteria);
+                }
+                ++last;
+            }
+            m_values.resize( last * m_numCriteria);
+        }
+        std::vector<WeightType>::iterator row = m_values.insert( m_values.begin() + pos * m_numCriteria, m_numCriteria, 0);
+        for ( unsigned int j = 0; j < m_numCriteria; ++j, ++row)
+        {
+            *row = other[j];
+        }
+        return true;
+    }
+
+    /**
+     * @brief Appends the vectors of the bag to a list of labels, with the given predecessor
+     */
+    void copyTo( std::vector<Label>& labels, void* pred) const
+    {
+        for ( unsigned int i = 0; i < size(); ++i)
+        {
+            labels.push_back( Label( get( i), pred, 0));
+        }
+    }
+
+private:
+    unsigned int m_numCriteria;
+    std::vector<WeightType> m_values;
+
+    /**
+     * @brief Lexicographic comparison between the i-th vector of the bag and another vector
+     */
+    int compare( const unsigned int& i, const CriteriaList& other) const
+    {
+        const WeightType* row = &m_values[i * m_numCriteria];
+        for ( unsigned int j = 0; j < m_numCriteria; ++j)
+        {
+            if ( row[j] != other[j]) return row[j] < other[j] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief First position whose vector is not lexicographically smaller than the given one
+     */
+    unsigned int position( const CriteriaList& other) const
+    {
+        unsigned int first = 0, count = size();
+        while ( count > 0)
+        {
+            unsigned int step = count / 2;
+            if ( compare( first + step, other) < 0)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    bool isDominated( const CriteriaList& other, const unsigned int& pos) const
+    {
+        if ( pos < size() && compare( pos, other) == 0) return true;
+        if ( m_numCriteria == 2)
+        {
+            return pos > 0 && m_values[2 * pos - 1] <= other[1];
+        }
+        for ( unsigned int i = 0; i < pos; ++i)
+        {
+            const WeightType* row = &m_values[i * m_numCriteria];
+            unsigned int j = 1;
+            while ( j < m_numCriteria && row[j] <= other[j]) ++j;
+            if ( j == m_numCriteria) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks whether a vector dominates the i-th vector of the bag
+     */
+    bool dominates( const CriteriaList& other, const unsigned int& i) const
+    {
+        const WeightType* row = &m_values[i * m_numCriteria];
+        for ( unsigned int j = 0; j < m_numCriteria; ++j)
+        {
+            if ( other[j] > row[j]) return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @class LabelTree
+ *
+ * @brief Tree of the labels generated by a query, stored as two arrays holding the parent label and the node id of
+ * every label
+ *
+ * A label only records where it comes from, so the path of any label is rebuilt by following the parents up to the
+ * root, and the paths of all the labels share their common prefixes. The arrays keep their capacity when cleared, so
+ * the tree allocates only while a query grows beyond the largest one seen so far.
+ */
+class LabelTree
+{
+public:
+    static const unsigned int NONE = 0xFFFFFFFF;
+
+    void clear()
+    {
+        m_parents.clear();
+        m_nodes.clear();
+    }
+
+    unsigned int size() const
+    {
+        return m_parents.size();
+    }
+
+    /**
+     * @brief Adds a label at a node, derived from the parent label (NONE for the root)
+     *
+     * @return The index of the new label
+     */
+    unsigned int add( unsigned int parent, unsigned int nodeId)
+    {
+        assert( parent == NONE || parent < size());
+        m_parents.push_back( parent);
+        m_nodes.push_back( nodeId);
+        return m_parents.size() - 1;
+    }
+
+    const unsigned int& getParent( const unsigned int& label) const
+    {
+        return m_parents[label];
+    }
+
+    const unsigned int& getNode( const unsigned int& label) const
+    {
+        return m_nodes[label];
+    }
+
+    /**
+     * @brief Gets the ids of the nodes on the path of a label, from the root to the node of the label
+     */
+    void getPath( unsigned int label, std::vector<unsigned int>& nodeIds) const
+    {
+        nodeIds.clear();
+        for ( ; label != NONE; label = m_parents[label])
+        {
+            nodeIds.push_back( m_nodes[label]);
+        }
+        std::reverse( nodeIds.begin(), nodeIds.end());
+    }
+
+private:
+    std::vector<unsigned int> m_parents;
+    std::vector<unsigned int> m_nodes;
 };
 
 class Node: DefaultGraphItem
@@ -325,10 +736,13 @@ public:
     std::vector<Label> g_cl;
     unsigned int timestamp;
     CriteriaList heuristicList;
+    std::vector<CriteriaList> heuristicSet;  // optional set of lower bounds, used when the ideal point is loose
     unsigned int id;
     unsigned int pqitem, secondary_pqitem;
     bool marked;
     unsigned int dist;
+    unsigned int g2_min;         // minimum second criterion closed at the node (BOA*)
+    TruncatedFront clFront;      // G_cl without its first criterion (NAMOA*dr)
     //void* succ;
     //unsigned int selectionID;
 };
@@ -372,12 +786,12 @@ public:
 struct Edge: DefaultGraphItem
 {
     Edge( unsigned int data = 0)
-        : criteriaList( NUM_CRITERIA)  // aquí hay que cambiar para nobjetivos
+        : criteriaList( NUM_CRITERIA), id( 0)  // aquí hay que cambiar para nobjetivos
     {
     }
 
     CriteriaList criteriaList;
-    //unsigned int flags;
+    unsigned int id;             // position of the edge, indexes its arc flags (see MulticriteriaArc)
 };
 
 
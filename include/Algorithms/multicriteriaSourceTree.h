@@ -0,0 +1,244 @@
+#ifndef MULTICRITERIASOURCETREE_H
+#define MULTICRITERIASOURCETREE_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/multicriteriaGraph.h>
+
+/**
+ * @class MulticriteriaSourceTree
+ *
+ * @brief Blind multicriteria search rooted on a source node that is kept alive between queries
+ *
+ * The labels of every node are kept in a ParetoBag (see MulticriteriaDijkstra). The search only grows as far as
+ * needed by the requested targets: a label that is dominated by the labels of every pending target is not expanded
+ * but deferred. The Pareto efficient costs of the pending targets are final when the queue runs empty. When new
+ * targets are requested from the same source, the deferred labels are queued again and the search resumes from the
+ * frontier it left, instead of starting from scratch.
+ *
+ * Resumed labels can be lexicographically smaller than labels expanded before, so a label expanded earlier may be
+ * dominated later on. The bags are exact anyway: a dominated label is removed from its bag, and the labels derived
+ * from it are removed as soon as the ones derived from the dominating label are generated.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class MulticriteriaSourceTree
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    MulticriteriaSourceTree( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_source(graph.endNodes()),
+                        m_settledLabels(0)
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_bags.assign( maxId + 1, ParetoBag( numCriteria));
+        m_final.assign( maxId + 1, false);
+    }
+
+    /**
+     * @brief Discards the current search and roots a new one on s
+     */
+    void setSource( const NodeIterator& s)
+    {
+        ++(*m_timestamp);
+        for ( unsigned int i = 0; i < m_touched.size(); ++i)
+        {
+            m_bags[m_touched[i]].clear();
+            m_final[m_touched[i]] = false;
+        }
+        m_touched.clear();
+        m_pending.clear();
+        m_deferred.clear();
+        pq.clear();
+
+        m_source = s;
+        CriteriaList zero( m_numCriteria);
+        bag( s).insert( zero);
+        pq.insert( zero, s);
+    }
+
+    /**
+     * @brief Requests the Pareto efficient costs of a target. They are computed by the next call to run
+     */
+    void addTarget( const NodeIterator& t)
+    {
+        assert( m_source != G.endNodes());
+        if ( m_final[t->id]) return;
+        m_touched.push_back( t->id);
+        m_pending.push_back( t);
+    }
+
+    /**
+     * @brief Grows the search until the costs of every requested target are final
+     */
+    void run()
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
+
+        if ( m_pending.empty()) return;
+        // labels deferred for the previous targets may be needed by the new ones
+        for ( unsigned int i = 0; i < m_deferred.size(); ++i)
+        {
+            pq.insert( m_deferred[i].first, m_deferred[i].second);
+        }
+        m_deferred.clear();
+
+        while( !pq.empty())
+        {
+            CriteriaList g_u = pq.minKey();
+            u = pq.minItem();
+            pq.popMin();
+            if ( !( m_bags[u->id].contains( g_u)))
+            {
+                continue;
+            }
+            if ( isDominatedByTargets( g_u))
+            {
+                m_deferred.push_back( std::make_pair( g_u, u));
+                continue;
+            }
+            ++m_settledLabels;
+
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                CriteriaList g_v = g_u + e->criteriaList;
+                if ( !( bag( v).insert( g_v)))
+                {
+                    continue;
+                }
+                if ( isDominatedByTargets( g_v))
+                {
+                    m_deferred.push_back( std::make_pair( g_v, v));
+                }
+                else
+                {
+                    pq.insert( g_v, v);
+                }
+            }
+        }
+        for ( unsigned int i = 0; i < m_pending.size(); ++i)
+        {
+            m_final[m_pending[i]->id] = true;
+        }
+        m_pending.clear();
+    }
+
+    /**
+     * @brief Returns the labels of a node, in lexicographic order. They are its Pareto efficient costs once it is final
+     */
+    const ParetoBag& getBag( const NodeIterator& u) const
+    {
+        return m_bags[u->id];
+    }
+
+    bool isFinal( const NodeIterator& u) const
+    {
+        return m_final[u->id];
+    }
+
+    /**
+     * @brief Sets the approximation factor used to prune with the labels of the targets (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        if ( epsilon != m_epsilon) m_source = G.endNodes();
+        m_epsilon = epsilon;
+    }
+
+    /**
+     * @brief Keeps the current search if the source is the same one, otherwise it starts a new one
+     */
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        assert( nCriteria == m_numCriteria);
+        if ( s != m_source)
+        {
+            setSource( s);
+        }
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        if ( s != m_source)
+        {
+            setSource( s);
+        }
+        m_settledLabels = 0;
+        addTarget( t);
+        run();
+        t->g_cl.clear();
+        m_bags[t->id].copyTo( t->g_cl, t->getDescriptor());
+    }
+
+    /**
+     * @brief Returns the number of labels expanded by the last call to runQuery, or since the source was set
+     */
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_settledLabels;
+    }
+
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    NodeIterator m_source;
+    unsigned int m_settledLabels;
+    std::vector<ParetoBag> m_bags;
+    std::vector<bool> m_final;
+    std::vector<unsigned int> m_touched;
+    std::vector<NodeIterator> m_pending;
+    std::vector< std::pair<CriteriaList, NodeIterator> > m_deferred;
+    std::vector<double> m_epsilon;
+
+    ParetoBag& bag( const NodeIterator& u)
+    {
+        ParetoBag& b = m_bags[u->id];
+        if ( b.empty()) m_touched.push_back( u->id);
+        return b;
+    }
+
+    /**
+     * @brief A label can be left aside if, for every pending target, a label of the target dominates it
+     */
+    bool isDominatedByTargets( const CriteriaList& g_v)
+    {
+        CriteriaList bound = m_epsilon.empty() ? g_v : g_v.inflate( m_epsilon);
+        for ( unsigned int i = 0; i < m_pending.size(); ++i)
+        {
+            if ( !( m_bags[m_pending[i]->id].isDominated( bound)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // MULTICRITERIASOURCETREE_H
@@ -3,6 +3,10 @@
 
 #include <Structs/Trees/priorityQueue.h>
 #include <Utilities/geographic.h>
+#include <Algorithms/geometricContainers.h>
+#include <Algorithms/supportedSolutions.h>
+#include <Utilities/queryLimits.h>
+#include <functional>
 #include <memory>
 
 template<class GraphType, template <typename graphType> class HeuristicGraphType>
@@ -16,6 +20,7 @@ public:
 
     typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
     typedef typename PriorityQueueType::PQItem PQItem;
+    typedef std::function<void( const CriteriaList&, const std::vector<NodeIterator>&)> SolutionSink;
 
     /**
      * @brief Constructor
@@ -24,11 +29,93 @@ public:
      * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is visited or not
      */
     NamoaStar2( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
-                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph)
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph),
+                        m_containers(0), m_prepass(0), m_complete(true)
     {
     }
 
 
+    /**
+     * @brief Sets the approximation factor of every criterion. A label is pruned when a solution (1+epsilon)-dominates
+     * its evaluation vector, so every Pareto efficient cost is (1+epsilon)-dominated by one of the solutions returned.
+     * An empty vector (the default) runs the exact search
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    /**
+     * @brief Only the edges whose geometric container holds the target are relaxed (see NamoaStarGC). A null
+     * pointer (the default) relaxes every edge
+     */
+    void setGeometricContainers( const GeometricContainers<GraphType>* containers)
+    {
+        m_containers = containers;
+    }
+
+    /**
+     * @brief Runs a prepass before every query (see NamoaStarSupported). Its solutions are output as they are and the
+     * labels they dominate are pruned from the first iteration. A null pointer (the default) runs no prepass
+     */
+    void setSupportedSolutions( SupportedSolutions<GraphType>* prepass)
+    {
+        m_prepass = prepass;
+    }
+
+    /**
+     * @brief Sets a function called with every solution (its cost vector and path from s to t) as soon as it is found.
+     * The solutions arrive in lexicographic order, while the query is running
+     */
+    void setSolutionSink( const SolutionSink& sink)
+    {
+        m_sink = sink;
+    }
+
+    /**
+     * @brief Sets the limits of the next queries. When one of them is hit, the query stops with the solutions found
+     * so far in G_cl(t), isComplete() returns false and getFrontier() gives the lower bounds of the missing solutions
+     */
+    void setQueryLimits( const QueryLimits& limits)
+    {
+        m_limits = limits;
+    }
+
+    /**
+     * @brief Returns false if the last query was stopped by its limits
+     */
+    bool isComplete() const
+    {
+        return m_complete;
+    }
+
+    /**
+     * @brief Gets the evaluation vectors (f) of the open labels when the last query was stopped, filtered to the ones
+     * not dominated by each other or by the solutions. Every Pareto efficient cost not in G_cl(t) is dominated by (or
+     * equal to) one of them. It is empty when the query completed
+     */
+    void getFrontier( std::vector<CriteriaList>& frontier) const
+    {
+        frontier.clear();
+        for ( unsigned int i = 0; i < m_frontier.size(); ++i)
+        {
+            frontier.push_back( m_frontier.get( i));
+        }
+    }
+
+    /**
+     * @brief Gets the paths, from s to t, of the solutions of the last query in the order of G_cl(t)
+     */
+    void extractPaths( const NodeIterator& t, std::vector< std::vector<NodeIterator> >& paths) const
+    {
+        paths.resize( t->g_cl.size());
+        for ( unsigned int i = 0; i < t->g_cl.size(); ++i)
+        {
+            getPath( t->g_cl[i].getTreeIndex(), paths[i]);
+        }
+    }
+
     void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
     {
         NodeIterator u, lastNode;
@@ -37,6 +124,9 @@ public:
             //u->labels.clear();
             u->g_op.clear();
             u->g_cl.clear();
+            u->heuristicSet.clear();
+            if ( u->id >= m_nodesById.size()) m_nodesById.resize( u->id + 1);
+            m_nodesById[u->id] = u;
         }
         m_heuristicEngine.init( s, t, nCriteria);
         pq.clear();
@@ -53,17 +143,29 @@ public:
         EdgeIterator e,lastEdge;
 
         m_generatedLabels = 0;
+        m_storedLabels = 1;
+        m_complete = true;
+        m_frontier.clear();
+        m_tree.clear();
+        m_guard.start( m_limits);
         assert( hasFeasiblePotentials(t));
         ++(*m_timestamp);
 
          unsigned int* pqitem = new unsigned int();
         // std::cout << "pqitem: " << *pqitem << std::endl;
         //s->labels.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem));
-        s->g_op.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem));
+        s->g_op.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem, m_tree.add( LabelTree::NONE, s->id)));
         pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s, &(s->pqitem));
+        seed( s, t);
 
         while( !pq.empty())
         {
+            if ( m_guard.isExceeded( m_generatedLabels, m_storedLabels))
+            {
+                m_complete = false;
+                buildFrontier( t);
+                break;
+            }
             // get the minimum lexicographic evaluation vector (f) from the PQ and its key
             CriteriaList minCriteria = pq.min().key;
             u = pq.minItem();
@@ -71,6 +173,7 @@ public:
             pq.popMin();
             // calculate its cost vector (g)
             CriteriaList g_u = minCriteria - u->heuristicList;
+            unsigned int treeIndex = u->g_op.front().getTreeIndex();
             ++m_generatedLabels;
 
             if (DEBUG == 1) {
@@ -83,8 +186,27 @@ public:
                 o_debug << std::endl;
             }
 
-            // move the label from G_op(u) to G_cl(u)
-            moveToClosed( g_u, u);
+            if ( u == t)
+            {
+                closeSeeds( t, &g_u);
+            }
+            if ( ( u == t) && ( isApproximatedBySolutions( t, g_u) || m_seeds.contains( g_u)))
+            {
+                // a solution within the approximation factor is known, the label is dropped
+                u->g_op.erase( u->g_op.begin());
+            }
+            else
+            {
+                // move the label from G_op(u) to G_cl(u)
+                moveToClosed( g_u, u);
+                if ( ( u == t) && m_sink)
+                {
+                    // the labels are closed in lexicographic order, so a solution is final once closed
+                    std::vector<NodeIterator> path;
+                    getPath( treeIndex, path);
+                    m_sink( g_u, path);
+                }
+            }
             // whenever there are more labels in G_op(u), insert the best in PQ
             if ( !( u->g_op.empty()))
             {
@@ -105,25 +227,52 @@ public:
             {
                 continue;
             }
-            if ( isDominatedBySolutions( t, minCriteria))
+            if ( isDominatedBySolutions( t, g_u, u))
             {
                 if (DEBUG == 1) {
                     o_debug << "  It is dominated by G_cl(u). \n";
                 }
                 continue;
             }
+            // the edges are relaxed in three passes, so the loads of the successors overlap instead of following each
+            // other: the first one gathers the successors and prefetches them, the second one computes their cost and
+            // evaluation vectors and prefetches their labels, and the last one checks and inserts the labels
+            m_successors.clear();
             for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
             {
+                if ( ( m_containers != 0) && !( m_containers->contains( e, t)))
+                {
+                    continue;
+                }
                 v = G.target(e);
-                /*
-                if ( v->timestamp != (*m_timestamp))
+                __builtin_prefetch( &(*v));
+                __builtin_prefetch( &( e->criteriaList[0]));
+                m_successors.push_back( std::make_pair( e, v));
+            }
+            if ( m_successorCosts.size() < m_successors.size())
+            {
+                m_successorCosts.resize( m_successors.size(), CriteriaList( m_numCriteria));
+                m_successorEvaluations.resize( m_successors.size(), CriteriaList( m_numCriteria));
+            }
+            for ( unsigned int i = 0; i < m_successors.size(); ++i)
+            {
+                e = m_successors[i].first;
+                v = m_successors[i].second;
+                CriteriaList& g_v = m_successorCosts[i];
+                CriteriaList& f_v = m_successorEvaluations[i];
+                for ( unsigned int k = 0; k < m_numCriteria; ++k)
                 {
-                    v->labels.clear();
-                    v->timestamp = (*m_timestamp);
+                    g_v[k] = g_u[k] + e->criteriaList[k];
+                    f_v[k] = g_v[k] + v->heuristicList[k];
                 }
-                */
-                CriteriaList g_v = g_u + e->criteriaList;
-                CriteriaList heuristicCost = g_v + v->heuristicList;
+                if ( !( v->g_cl.empty())) __builtin_prefetch( &( v->g_cl.back()));
+                if ( !( v->g_op.empty())) __builtin_prefetch( &( v->g_op.front()));
+            }
+            for ( unsigned int i = 0; i < m_successors.size(); ++i)
+            {
+                v = m_successors[i].second;
+                CriteriaList& g_v = m_successorCosts[i];
+                CriteriaList& heuristicCost = m_successorEvaluations[i];
 
                 if (DEBUG == 1) {
                     o_debug << " Expanding |" << v->id << "| ";
@@ -135,7 +284,7 @@ public:
                     o_debug << std::endl;
                 }
 
-                if ( isDominatedBySolutions( t, heuristicCost))
+                if ( v->heuristicSet.empty() ? isDominatedBySolutions( t, heuristicCost) : isDominatedBySolutions( t, g_v, v))
                 {
                     if (DEBUG == 1) {
                         o_debug << "  It is dominated by the node labels (f). \n";
@@ -161,10 +310,12 @@ public:
                         // check if g_v is dominated, if not, insert g_v in G_op(v) and remove the labels dominated by g_v
                         bool inserted = false;
                         unsigned int* pqitem = new unsigned int();
-                        v->g_op = GopManagement( v, u, g_v, pqitem, inserted);
+                        v->g_op = GopManagement( v, u, g_v, pqitem, m_tree.size(), inserted);
                         // if inserted, then insert in PQ as well (if applies)
                         if ( inserted)
                         {
+                            m_tree.add( treeIndex, v->id);
+                            ++m_storedLabels;
                             if ( v->g_op.size() == 1)
                             {
                                 if ( first == nullptr) // there wasn't any label before, insert in PQ
@@ -194,6 +345,7 @@ public:
                 }
             }
         }
+        closeSeeds( t, 0);
     }
 
     const unsigned int& getGeneratedLabels()
@@ -220,11 +372,101 @@ private:
     unsigned int m_numCriteria;
     unsigned int* m_timestamp;
     HeuristicGraphType<GraphType> m_heuristicEngine;
+    std::vector<double> m_epsilon;
+    const GeometricContainers<GraphType>* m_containers;
+    SupportedSolutions<GraphType>* m_prepass;
+    ParetoBag m_seeds;                  // solutions of the prepass
+    std::vector<Label> m_seedLabels;    // in lexicographic order, the first m_nextSeed are in G_cl(t)
+    unsigned int m_nextSeed;
+    SolutionSink m_sink;
+    QueryLimits m_limits;
+    QueryGuard m_guard;
+    unsigned int m_storedLabels;   // labels inserted in G_op, an upper bound of the labels held by the query
+    bool m_complete;
+    ParetoBag m_frontier;
+    std::vector< std::pair<EdgeIterator, NodeIterator> > m_successors;     // scratch of the relaxation of a label
+    std::vector<CriteriaList> m_successorCosts, m_successorEvaluations;
+    LabelTree m_tree;
+    std::vector<NodeIterator> m_nodesById;
+
+    /**
+     * @brief Collects the evaluation vectors of the open labels that may still lead to a missing solution
+     */
+    void buildFrontier( const NodeIterator& t)
+    {
+        NodeIterator u, lastNode;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for ( std::vector<Label>::const_iterator it = u->g_op.begin(); it != u->g_op.end(); ++it)
+            {
+                CriteriaList f_u = it->getCriteriaList() + u->heuristicList;
+                if ( ( u == t) || !( isDominatedBySolutions( t, it->getCriteriaList(), u)))
+                {
+                    m_frontier.insert( f_u);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Runs the prepass, if any, and adds the paths of its solutions to the label tree
+     */
+    void seed( const NodeIterator& s, const NodeIterator& t)
+    {
+        m_seeds = ParetoBag( m_numCriteria);
+        m_seedLabels.clear();
+        m_nextSeed = 0;
+        if ( m_prepass == 0) return;
+        m_prepass->run( s, t);
+        for ( unsigned int i = 0; i < m_prepass->size(); ++i)
+        {
+            if ( !( m_seeds.insert( m_prepass->getCosts( i)))) continue;
+            const std::vector<unsigned int>& path = m_prepass->getPath( i);
+            unsigned int treeIndex = LabelTree::NONE;
+            for ( unsigned int j = 0; j < path.size(); ++j)
+            {
+                treeIndex = m_tree.add( treeIndex, path[j]);
+            }
+            void* pred = ( path.size() > 1) ? m_nodesById[path[path.size() - 2]]->getDescriptor() : 0;
+            m_seedLabels.push_back( Label( m_prepass->getCosts( i), pred, 0, treeIndex));
+        }
+        std::sort( m_seedLabels.begin(), m_seedLabels.end(), []( const Label& a, const Label& b)
+        {
+            return a.getCriteriaList() < b.getCriteriaList();
+        });
+    }
+
+    /**
+     * @brief Moves the solutions of the prepass lexicographically smaller than bound (all of them if it is null) to
+     * G_cl(t), so G_cl(t) stays in lexicographic order
+     */
+    void closeSeeds( const NodeIterator& t, const CriteriaList* bound)
+    {
+        for ( ; m_nextSeed < m_seedLabels.size(); ++m_nextSeed)
+        {
+            const Label& label = m_seedLabels[m_nextSeed];
+            if ( ( bound != 0) && !( label.getCriteriaList() < *bound)) return;
+            t->g_cl.push_back( label);
+            if ( m_sink)
+            {
+                std::vector<NodeIterator> path;
+                getPath( label.getTreeIndex(), path);
+                m_sink( label.getCriteriaList(), path);
+            }
+        }
+    }
 
     void moveToClosed( const CriteriaList& g_u, const NodeIterator& u)
     {
-        // insert into G_cl(u)
-        u->g_cl.push_back( Label( g_u, u->getDescriptor(), 0));
+        // insert into G_cl(u), keeping the predecessor of the open label
+        if ( u->g_op.empty())
+        {
+            u->g_cl.push_back( Label( g_u, 0, 0));
+        }
+        else
+        {
+            u->g_cl.push_back( Label( g_u, u->g_op.front().getPredecessor(), 0, u->g_op.front().getTreeIndex()));
+        }
         // remove from G_op(u)
         if ( !(u->g_op.empty()))
         {
@@ -232,8 +474,26 @@ private:
         }
     }
 
+    /**
+     * @brief Builds the path, from the source, of a label of the tree
+     */
+    void getPath( const unsigned int& treeIndex, std::vector<NodeIterator>& path) const
+    {
+        std::vector<unsigned int> nodeIds;
+        m_tree.getPath( treeIndex, nodeIds);
+        path.clear();
+        for ( unsigned int i = 0; i < nodeIds.size(); ++i)
+        {
+            path.push_back( m_nodesById[nodeIds[i]]);
+        }
+    }
+
     bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& f_v)
     { // performance of this should be further investigated // francis
+        if ( !( m_seeds.empty()) && m_seeds.isDominated( f_v))
+        {
+            return true;
+        }
         if ( ( t->g_op.empty()) && ( t->g_cl.empty()))
         {
             return false;
@@ -242,11 +502,38 @@ private:
         {
             return true;
         }
-        else if ( (!(t->g_cl.empty())) && (f_v.isDominatedBy( t->g_cl.back().getCriteriaList())))
+        else return isApproximatedBySolutions( t, f_v);
+    }
+
+    /**
+     * @brief Checks whether f_v is (1+epsilon)-dominated by the solutions closed at t. Open labels of t are not used
+     * with the approximation factor, since they may be dropped later on and the error would accumulate
+     */
+    bool isApproximatedBySolutions( const NodeIterator& t, const CriteriaList& f_v)
+    {
+        return ( !(t->g_cl.empty())) && ( t->g_cl.back().getCriteriaList().epsilonDominates( f_v, m_epsilon));
+    }
+
+    /**
+     * @brief Checks whether every evaluation vector of a label is dominated by the solutions found so far
+     *
+     * When the heuristic engine provides a set of lower bounds for v, the label can be filtered only if the
+     * evaluation vectors built from all of them are dominated. Otherwise the ideal point is used.
+     */
+    bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& g_v, const NodeIterator& v)
+    {
+        if ( v->heuristicSet.empty())
+        {
+            return isDominatedBySolutions( t, g_v + v->heuristicList);
+        }
+        for ( std::vector<CriteriaList>::const_iterator it = v->heuristicSet.begin(); it != v->heuristicSet.end(); ++it)
         {
-            return true;
+            if ( !( isDominatedBySolutions( t, g_v + *it)))
+            {
+                return false;
+            }
         }
-        else return false;
+        return true;
     }
 
     bool isDominatedByClosed( const NodeIterator& v, const CriteriaList& g_v)
@@ -261,11 +548,11 @@ private:
         }
     }
 
-    std::vector<Label> GopManagement( NodeIterator& v, NodeIterator& u, CriteriaList& g_v, unsigned int* pqitem, bool& inserted = false)
+    std::vector<Label> GopManagement( NodeIterator& v, NodeIterator& u, CriteriaList& g_v, unsigned int* pqitem, const unsigned int& treeIndex, bool& inserted)
     {
         std::vector<Label> new_g_op;
         if ( v->g_op.empty()) {
-            new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem));
+            new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem, treeIndex));
             inserted = true;
             return new_g_op;
         }
@@ -289,7 +576,7 @@ private:
             {
                 if ( g_v < it->getCriteriaList())
                 {
-                    new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem));
+                    new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem, treeIndex));
                     inserted = true;
                     if (DEBUG == 1) {
                         o_debug << "  Inserting in G_op |" << v->id << "| ";
@@ -315,7 +602,7 @@ private:
         }
         if ( !( inserted))
         {
-            new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem));
+            new_g_op.push_back( Label( g_v, u->getDescriptor(), pqitem, treeIndex));
             inserted = true;
             if (DEBUG == 1) {
                 o_debug << "  Inserting in G_op |" << v->id << "| ";
@@ -535,5 +822,105 @@ private:
 
 };
 
+/**
+ * @class NamoaStarGC
+ *
+ * @brief NAMOA* (see NamoaStar2) restricted to the edges whose geometric container holds the target
+ *
+ * The containers are computed on the first query, or loaded from GEOMETRIC_CONTAINERS_FILE when it holds the
+ * containers of the same graph. Otherwise they are written to it once computed.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class NamoaStarGC: public NamoaStar2<GraphType, HeuristicGraphType>
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+
+    NamoaStarGC( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                 NamoaStar2<GraphType, HeuristicGraphType>( graph, numCriteria, timestamp),
+                 m_containers( new GeometricContainers<GraphType>( graph, numCriteria))
+    {
+        this->setGeometricContainers( m_containers.get());
+    }
+
+    /**
+     * @brief Computes the containers, or loads them from GEOMETRIC_CONTAINERS_FILE, unless they are known
+     */
+    void loadOrPreprocess()
+    {
+        if ( !( m_containers->isPreprocessed()) && ( GEOMETRIC_CONTAINERS_FILE.empty() || !( m_containers->load( GEOMETRIC_CONTAINERS_FILE))))
+        {
+            m_containers->preprocess();
+            if ( !( GEOMETRIC_CONTAINERS_FILE.empty())) m_containers->save( GEOMETRIC_CONTAINERS_FILE);
+        }
+    }
+
+    /**
+     * @brief Uses the containers of another object, run on a graph with the same edges, instead of its own
+     */
+    void sharePreprocessing( const NamoaStarGC& other)
+    {
+        m_containers = other.m_containers;
+        this->setGeometricContainers( m_containers.get());
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        loadOrPreprocess();
+        NamoaStar2<GraphType, HeuristicGraphType>::init( s, t, nCriteria);
+    }
+
+private:
+    std::shared_ptr< GeometricContainers<GraphType> > m_containers;
+};
+
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+void loadOrPreprocess( NamoaStarGC<GraphType, HeuristicGraphType>& algorithm)
+{
+    algorithm.loadOrPreprocess();
+}
+
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+void sharePreprocessing( NamoaStarGC<GraphType, HeuristicGraphType>& from, NamoaStarGC<GraphType, HeuristicGraphType>& to)
+{
+    to.sharePreprocessing( from);
+}
+
+/**
+ * @class NamoaStarSupported
+ *
+ * @brief NAMOA* (see NamoaStar2) seeded with the lexicographic optima and some supported solutions of the query,
+ * found by scalar Dijkstra searches before it runs (see SupportedSolutions)
+ *
+ * Without upper bounds on the front, the first iterations of NAMOA* prune nothing. The solutions of the prepass
+ * bound it from the start, and they are output as found, with their paths.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class NamoaStarSupported: public NamoaStar2<GraphType, HeuristicGraphType>
+{
+public:
+    NamoaStarSupported( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        NamoaStar2<GraphType, HeuristicGraphType>( graph, numCriteria, timestamp), m_prepass( graph, numCriteria)
+    {
+        // a complete dichotomic search costs more than the pruning saves, a few searches bound most of the front
+        m_prepass.setMaxSearches( 4);
+        this->setSupportedSolutions( &m_prepass);
+    }
+
+    SupportedSolutions<GraphType>& getSupportedSolutions()
+    {
+        return m_prepass;
+    }
+
+private:
+    SupportedSolutions<GraphType> m_prepass;
+};
+
 #endif // NAMOASTAR2_H
 
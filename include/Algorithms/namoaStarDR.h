@@ -0,0 +1,253 @@
+#ifndef NAMOASTARDR_H
+#define NAMOASTARDR_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <memory>
+
+/**
+ * @class NamoaStarDR
+ *
+ * @brief NAMOA* with dimensionality reduction (NAMOA*dr)
+ *
+ * With a consistent heuristic the labels of a node are closed in lexicographic order of their cost vector, and every
+ * label generated at a node is lexicographically not smaller than the ones already closed there. The first criterion
+ * of the closed labels is then never greater than the one of the label being checked, so the dominance checks against
+ * G_cl(v) and against the solutions (G_cl(t)) only need the remaining k-1 criteria. Those checks are done against the
+ * truncated front of every node (see TruncatedFront), which is exact for any number of criteria.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class NamoaStarDR
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::NodeData        NodeData;
+
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+    typedef typename PriorityQueueType::PQItem PQItem;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is visited or not
+     */
+    NamoaStarDR( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph)
+    {
+        assert( m_numCriteria >= 2);
+    }
+
+    /**
+     * @brief Sets the approximation factor of every criterion. A label is pruned when a solution (1+epsilon)-dominates
+     * its evaluation vector, so every Pareto efficient cost is (1+epsilon)-dominated by one of the solutions returned.
+     * An empty vector (the default) runs the exact search
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        NodeIterator u, lastNode;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            u->g_op.clear();
+            u->g_cl.clear();
+            u->clFront.clear();
+            u->heuristicSet.clear();
+        }
+        m_heuristicEngine.init( s, t, nCriteria);
+        pq.clear();
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
+
+        m_generatedLabels = 0;
+        ++(*m_timestamp);
+
+        s->g_op.push_back(Label( CriteriaList(m_numCriteria), 0, 0));
+        pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s, &(s->pqitem));
+
+        while( !pq.empty())
+        {
+            CriteriaList f_u = pq.min().key;
+            u = pq.minItem();
+            pq.popMin();
+            CriteriaList g_u = f_u - u->heuristicList;
+            ++m_generatedLabels;
+
+            if (DEBUG == 1) {
+                o_debug << "\nIT: " << m_generatedLabels << "\nExtracting |" << u->id << "| ";
+                o_debug << "f: (";
+                f_u.print( o_debug, ", ");
+                o_debug << ") g: (";
+                g_u.print(o_debug, ", ");
+                o_debug << ")";
+                o_debug << std::endl;
+            }
+
+            if ( ( u == t) && t->clFront.dominates( g_u.inflate( m_epsilon)))
+            {
+                // a solution within the approximation factor is known, the label is dropped
+                u->g_op.erase( u->g_op.begin());
+            }
+            else
+            {
+                moveToClosed( g_u, u);
+            }
+            if ( !( u->g_op.empty()))
+            {
+                pq.insert( u->g_op.front().getCriteriaList() + u->heuristicList, u, &(u->pqitem));
+            }
+            if ( u == t)
+            {
+                continue;
+            }
+            // the label may have been generated before the last solution was found
+            if ( isDominatedBySolutions( t, g_u, u))
+            {
+                continue;
+            }
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                CriteriaList g_v = g_u + e->criteriaList;
+
+                if ( isDominatedBySolutions( t, g_v, v) || v->clFront.dominates( g_v))
+                {
+                    continue;
+                }
+                const bool wasEmpty = v->g_op.empty();
+                CriteriaList first;
+                if ( !wasEmpty)
+                {
+                    first = v->g_op.front().getCriteriaList();
+                }
+                if ( !( insertOpen( v, u, g_v)))
+                {
+                    continue;
+                }
+                CriteriaList f_v = g_v + v->heuristicList;
+                if ( wasEmpty)
+                {
+                    pq.insert( f_v, v, &(v->pqitem));
+                }
+                else if ( !( v->g_op.front().getCriteriaList() == first))
+                {
+                    pq.decrease( f_v, &(v->pqitem));
+                }
+            }
+        }
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_generatedLabels;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    std::vector<double> m_epsilon;
+
+    void moveToClosed( const CriteriaList& g_u, const NodeIterator& u)
+    {
+        u->g_cl.push_back( Label( g_u, u->getDescriptor(), 0));
+        u->clFront.insert( g_u);
+        if ( !(u->g_op.empty()))
+        {
+            u->g_op.erase( u->g_op.begin());
+        }
+    }
+
+    /**
+     * @brief Checks whether every evaluation vector of a label is (1+epsilon)-dominated by the solutions found so far.
+     * Inflating the vector keeps its first criterion not smaller than the one of the solutions, so the truncated front
+     * of t can still be used
+     */
+    bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& g_v, const NodeIterator& v)
+    {
+        if ( t->clFront.empty())
+        {
+            return false;
+        }
+        if ( v->heuristicSet.empty())
+        {
+            return t->clFront.dominates( ( g_v + v->heuristicList).inflate( m_epsilon));
+        }
+        for ( std::vector<CriteriaList>::const_iterator it = v->heuristicSet.begin(); it != v->heuristicSet.end(); ++it)
+        {
+            // the vectors of the set are not smaller than the ideal point, so the lexicographic order is kept
+            if ( !( t->clFront.dominates( ( g_v + *it).inflate( m_epsilon))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Inserts g_v in G_op(v), kept in lexicographic order, unless it is dominated by one of its labels.
+     * The labels dominated by g_v are removed
+     *
+     * @return True if g_v has been inserted
+     */
+    bool insertOpen( const NodeIterator& v, const NodeIterator& u, const CriteriaList& g_v)
+    {
+        std::vector<Label>& g_op = v->g_op;
+        std::vector<Label>::iterator position = g_op.end();
+        for ( std::vector<Label>::iterator it = g_op.begin(); it != g_op.end(); ++it)
+        {
+            if ( it->getCriteriaList().dominates( g_v))
+            {
+                return false;
+            }
+            if ( position == g_op.end() && g_v < it->getCriteriaList())
+            {
+                position = it;
+            }
+        }
+        unsigned int index = position - g_op.begin();
+        std::vector<Label>::iterator last = std::remove_if( g_op.begin() + index, g_op.end(), DominatedBy( g_v));
+        g_op.erase( last, g_op.end());
+        g_op.insert( g_op.begin() + index, Label( g_v, u->getDescriptor(), 0));
+        return true;
+    }
+
+    struct DominatedBy
+    {
+        DominatedBy( const CriteriaList& criteria): m_criteria( criteria)
+        {
+        }
+        bool operator()( const Label& label) const
+        {
+            return label.getCriteriaList().isDominatedBy( m_criteria);
+        }
+        const CriteriaList& m_criteria;
+    };
+};
+
+#endif // NAMOASTARDR_H
@@ -0,0 +1,287 @@
+#ifndef PARALLELNAMOASTAR_H
+#define PARALLELNAMOASTAR_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <Utilities/threadPool.h>
+#include <queue>
+
+/**
+ * @class ParallelNamoaStar
+ *
+ * @brief Asynchronous parallel NAMOA*. Implementation for graphs with edges labeled with multiple criteria
+ *
+ * Worker threads take labels from a MultiQueue, i.e. a few binary heaps per thread, each one with its own lock. A
+ * thread pushes to a random heap and pops from the best of two random heaps, so the labels are extracted in an order
+ * that is only close to the lexicographic order of their evaluation vectors (f). Idle threads keep sampling heaps,
+ * which takes the work queued by the others.
+ *
+ * Since the extraction order is relaxed, the search is label correcting: a label may be expanded and dominated later
+ * on. The labels of every node are kept in a ParetoBag guarded by a striped spinlock, and a label is only expanded if
+ * it is still in the bag of its node when it is extracted. A dominated label is removed from its bag, and the labels
+ * derived from it are removed as soon as the ones derived from the dominating label are generated, so the bags are
+ * exact when the search ends. The search ends when the counter of labels queued or being expanded drops to zero.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class ParallelNamoaStar
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    ParallelNamoaStar( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph),
+                        m_heaps( 2 * m_pool.size()), m_locks( 1024)
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_bags.assign( maxId + 1, ParetoBag( numCriteria));
+        m_touched.resize( m_pool.size());
+    }
+
+    /**
+     * @brief Sets the approximation factor used to prune with the solutions (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        for ( unsigned int thread = 0; thread < m_touched.size(); ++thread)
+        {
+            for ( unsigned int i = 0; i < m_touched[thread].size(); ++i)
+            {
+                m_bags[m_touched[thread][i]].clear();
+            }
+            m_touched[thread].clear();
+        }
+        m_heuristicEngine.init( s, t, nCriteria);
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        ++(*m_timestamp);
+        m_expandedLabels = 0;
+        m_pending = 1;
+
+        CriteriaList zero( m_numCriteria);
+        m_bags[s->id].insert( zero);
+        m_touched[0].push_back( s->id);
+        m_heaps[0].queue.push( Entry( zero + s->heuristicList, s));
+
+        m_pool.run( [&]( unsigned int thread)
+        {
+            work( thread, t);
+        });
+
+        t->g_cl.clear();
+        m_bags[t->id].copyTo( t->g_cl, t->getDescriptor());
+        m_generatedLabels = m_expandedLabels;
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+private:
+    struct Entry
+    {
+        Entry( const CriteriaList& key, const NodeIterator& node): f( key), u( node)
+        {
+        }
+        CriteriaList f;
+        NodeIterator u;
+    };
+
+    struct EntryComparator
+    {
+        bool operator()( const Entry& a, const Entry& b) const
+        {
+            return b.f < a.f;
+        }
+    };
+
+    class SpinLock
+    {
+    public:
+        SpinLock()
+        {
+            m_flag.clear();
+        }
+        SpinLock( const SpinLock&)
+        {
+            m_flag.clear();
+        }
+        void lock()
+        {
+            while ( m_flag.test_and_set( std::memory_order_acquire)) std::this_thread::yield();
+        }
+        bool tryLock()
+        {
+            return !m_flag.test_and_set( std::memory_order_acquire);
+        }
+        void unlock()
+        {
+            m_flag.clear( std::memory_order_release);
+        }
+    private:
+        std::atomic_flag m_flag;
+    };
+
+    struct Heap
+    {
+        SpinLock lock;
+        std::priority_queue< Entry, std::vector<Entry>, EntryComparator> queue;
+    };
+
+    GraphType& G;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    ThreadPool m_pool;
+    std::vector<Heap> m_heaps;
+    std::vector<SpinLock> m_locks;
+    std::vector<ParetoBag> m_bags;
+    std::vector< std::vector<unsigned int> > m_touched;  // [thread]
+    std::vector<double> m_epsilon;
+    std::atomic<long> m_pending;
+    std::atomic<unsigned int> m_expandedLabels;
+    unsigned int m_generatedLabels;
+
+    SpinLock& nodeLock( const NodeIterator& u)
+    {
+        return m_locks[u->id % m_locks.size()];
+    }
+
+    static unsigned int random( unsigned int& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    void push( const Entry& entry, unsigned int& state)
+    {
+        ++m_pending;
+        while ( true)
+        {
+            Heap& heap = m_heaps[random( state) % m_heaps.size()];
+            if ( !heap.lock.tryLock()) continue;
+            heap.queue.push( entry);
+            heap.lock.unlock();
+            return;
+        }
+    }
+
+    /**
+     * @brief Pops the best entry of two random heaps
+     *
+     * @return False if both heaps are empty
+     */
+    bool pop( Entry& entry, unsigned int& state)
+    {
+        unsigned int i = random( state) % m_heaps.size();
+        unsigned int j = random( state) % m_heaps.size();
+        if ( i == j) j = ( j + 1) % m_heaps.size();
+        if ( ( i > j)) std::swap( i, j);
+        m_heaps[i].lock.lock();
+        m_heaps[j].lock.lock();
+        Heap* best = 0;
+        if ( !m_heaps[i].queue.empty()) best = &m_heaps[i];
+        if ( !m_heaps[j].queue.empty() && ( best == 0 || m_heaps[j].queue.top().f < best->queue.top().f)) best = &m_heaps[j];
+        if ( best != 0)
+        {
+            entry = best->queue.top();
+            best->queue.pop();
+        }
+        m_heaps[j].lock.unlock();
+        m_heaps[i].lock.unlock();
+        return best != 0;
+    }
+
+    bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& f_v)
+    {
+        CriteriaList bound = m_epsilon.empty() ? f_v : f_v.inflate( m_epsilon);
+        SpinLock& lock = nodeLock( t);
+        lock.lock();
+        bool dominated = m_bags[t->id].isDominated( bound);
+        lock.unlock();
+        return dominated;
+    }
+
+    void work( const unsigned int thread, const NodeIterator& t)
+    {
+        EdgeIterator e,lastEdge;
+        unsigned int state = 2463534242u + 7919 * thread;
+        Entry entry( CriteriaList( m_numCriteria), t);
+
+        while ( m_pending > 0)
+        {
+            if ( !pop( entry, state))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            const NodeIterator& u = entry.u;
+            CriteriaList g_u = entry.f - u->heuristicList;
+            nodeLock( u).lock();
+            bool alive = m_bags[u->id].contains( g_u);
+            nodeLock( u).unlock();
+
+            if ( alive && ( u != t) && !isDominatedBySolutions( t, entry.f))
+            {
+                ++m_expandedLabels;
+                for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+                {
+                    NodeIterator v = G.target(e);
+                    CriteriaList g_v = g_u + e->criteriaList;
+                    CriteriaList f_v = g_v + v->heuristicList;
+                    if ( ( v != t) && isDominatedBySolutions( t, f_v))
+                    {
+                        continue;
+                    }
+                    SpinLock& lock = nodeLock( v);
+                    lock.lock();
+                    ParetoBag& bag = m_bags[v->id];
+                    if ( bag.empty()) m_touched[thread].push_back( v->id);
+                    bool inserted = bag.insert( g_v);
+                    lock.unlock();
+                    if ( inserted)
+                    {
+                        push( Entry( f_v, v), state);
+                    }
+                }
+            }
+            --m_pending;
+        }
+    }
+};
+
+#endif // PARALLELNAMOASTAR_H
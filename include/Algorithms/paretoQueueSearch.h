@@ -0,0 +1,253 @@
+#ifndef PARETOQUEUESEARCH_H
+#define PARETOQUEUESEARCH_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/multicriteriaGraph.h>
+#include <Utilities/threadPool.h>
+
+/**
+ * @class ParetoQueueSearch
+ *
+ * @brief Parallel multicriteria label-setting search settling a set of Pareto minimal labels per round (paPaSearch)
+ *
+ * With a consistent heuristic, a label whose evaluation vector (f) is not dominated by any other label of the queue
+ * can not be dominated by a label found later on, so all of them can be settled at once. Every round extracts labels
+ * from the queue in lexicographic order and keeps the ones that are not dominated by those extracted before; the
+ * dominated ones are put back. Since the labels left in the queue are lexicographically greater, the labels kept are
+ * Pareto minimal in the whole queue.
+ *
+ * The labels of a round are relaxed in parallel. Every thread writes the new labels to a private buffer per shard,
+ * shards being defined by the id of the head node. Then every shard is merged into the bags of its nodes by a single
+ * thread, so no locks are needed, and the labels that survive are inserted in the queue.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class ParetoQueueSearch
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+    typedef std::pair< CriteriaList, NodeIterator> Candidate;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    ParetoQueueSearch( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                        G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph),
+                        m_maxRoundSize(4096)
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        m_bags.assign( maxId + 1, ParetoBag( numCriteria));
+        unsigned int numThreads = m_pool.size();
+        m_buffers.assign( numThreads, std::vector< std::vector<Candidate> >( numThreads));
+        m_inserted.resize( numThreads);
+        m_touched.resize( numThreads);
+    }
+
+    /**
+     * @brief Sets the maximum number of labels settled in a round
+     */
+    void setMaxRoundSize( const unsigned int& size)
+    {
+        assert( size > 0);
+        m_maxRoundSize = size;
+    }
+
+    /**
+     * @brief Sets the approximation factor used to prune with the solutions (see NamoaStar2::setEpsilon)
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        for ( unsigned int shard = 0; shard < m_touched.size(); ++shard)
+        {
+            for ( unsigned int i = 0; i < m_touched[shard].size(); ++i)
+            {
+                m_bags[m_touched[shard][i]].clear();
+            }
+            m_touched[shard].clear();
+        }
+        m_heuristicEngine.init( s, t, nCriteria);
+        pq.clear();
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        m_generatedLabels = 0;
+        m_rounds = 0;
+        ++(*m_timestamp);
+
+        CriteriaList zero( m_numCriteria);
+        m_bags[s->id].insert( zero);
+        m_touched[shard( s)].push_back( s->id);
+        pq.insert( zero + s->heuristicList, s);
+
+        while( !pq.empty())
+        {
+            extractRound( t);
+            if ( m_round.empty()) continue;
+            ++m_rounds;
+            m_generatedLabels += m_round.size();
+            relaxRound( t);
+            mergeRound();
+        }
+        t->g_cl.clear();
+        m_bags[t->id].copyTo( t->g_cl, t->getDescriptor());
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+    /**
+     * @brief Returns the number of rounds of the last query
+     */
+    const unsigned int& getRounds()
+    {
+        return m_rounds;
+    }
+
+private:
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_generatedLabels;
+    unsigned int m_rounds;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    unsigned int m_maxRoundSize;
+    ThreadPool m_pool;
+    std::vector<ParetoBag> m_bags;
+    std::vector<Candidate> m_round;
+    std::vector< std::vector< std::vector<Candidate> > > m_buffers;  // [thread][shard]
+    std::vector< std::vector<Candidate> > m_inserted;                // [shard]
+    std::vector< std::vector<unsigned int> > m_touched;              // [shard]
+    std::vector<double> m_epsilon;
+
+    unsigned int shard( const NodeIterator& u) const
+    {
+        return u->id % m_pool.size();
+    }
+
+    bool isDominatedBySolutions( const NodeIterator& t, const CriteriaList& f_v) const
+    {
+        return m_bags[t->id].isDominated( m_epsilon.empty() ? f_v : f_v.inflate( m_epsilon));
+    }
+
+    /**
+     * @brief Extracts a set of labels that are Pareto minimal in the queue. Their cost vectors (g) are left in m_round
+     */
+    void extractRound( const NodeIterator& t)
+    {
+        std::vector< std::pair<CriteriaList, NodeIterator> > putBack;
+        TruncatedFront front;
+        m_round.clear();
+        while ( !pq.empty() && m_round.size() < m_maxRoundSize && putBack.size() <= m_round.size())
+        {
+            CriteriaList f_u = pq.minKey();
+            NodeIterator u = pq.minItem();
+            pq.popMin();
+            CriteriaList g_u = f_u - u->heuristicList;
+            if ( !( m_bags[u->id].contains( g_u)))
+            {
+                // a dominating label replaced it
+                continue;
+            }
+            if ( ( u != t) && isDominatedBySolutions( t, f_u))
+            {
+                continue;
+            }
+            if ( front.dominates( f_u))
+            {
+                putBack.push_back( std::make_pair( f_u, u));
+                continue;
+            }
+            front.insert( f_u);
+            m_round.push_back( std::make_pair( g_u, u));
+        }
+        for ( unsigned int i = 0; i < putBack.size(); ++i)
+        {
+            pq.insert( putBack[i].first, putBack[i].second);
+        }
+    }
+
+    void relaxRound( const NodeIterator& t)
+    {
+        m_pool.parallelFor( m_round.size(), [&]( unsigned int i, unsigned int thread)
+        {
+            EdgeIterator e,lastEdge;
+            const CriteriaList& g_u = m_round[i].first;
+            NodeIterator u = m_round[i].second;
+            if ( u == t) return;
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                NodeIterator v = G.target(e);
+                CriteriaList g_v = g_u + e->criteriaList;
+                if ( isDominatedBySolutions( t, g_v + v->heuristicList) || m_bags[v->id].isDominated( g_v))
+                {
+                    continue;
+                }
+                m_buffers[thread][shard( v)].push_back( std::make_pair( g_v, v));
+            }
+        });
+    }
+
+    void mergeRound()
+    {
+        m_pool.run( [&]( unsigned int s)
+        {
+            m_inserted[s].clear();
+            for ( unsigned int thread = 0; thread < m_buffers.size(); ++thread)
+            {
+                std::vector<Candidate>& buffer = m_buffers[thread][s];
+                for ( unsigned int i = 0; i < buffer.size(); ++i)
+                {
+                    ParetoBag& bag = m_bags[buffer[i].second->id];
+                    if ( bag.empty()) m_touched[s].push_back( buffer[i].second->id);
+                    if ( bag.insert( buffer[i].first))
+                    {
+                        m_inserted[s].push_back( buffer[i]);
+                    }
+                }
+                buffer.clear();
+            }
+        });
+        for ( unsigned int s = 0; s < m_inserted.size(); ++s)
+        {
+            for ( unsigned int i = 0; i < m_inserted[s].size(); ++i)
+            {
+                NodeIterator v = m_inserted[s][i].second;
+                pq.insert( m_inserted[s][i].first + v->heuristicList, v);
+            }
+        }
+    }
+};
+
+#endif // PARETOQUEUESEARCH_H
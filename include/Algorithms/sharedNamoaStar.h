@@ -0,0 +1,353 @@
+#ifndef SHAREDNAMOASTAR_H
+#define SHAREDNAMOASTAR_H
+
+#include <Structs/Graphs/sharedGraph.h>
+#include <Utilities/timer.h>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+
+/**
+ * @class SharedNamoaStar
+ *
+ * @brief NAMOA* with the ideal point heuristic on a SharedGraph
+ *
+ * The graph is only read, and the whole state of a query (heuristic, closed labels and queue) lives in the object, so
+ * every thread or process runs its own SharedNamoaStar on the same mapping. The ideal point of every node is computed
+ * by one backward Dijkstra search per criterion from the target. The labels are extracted in lexicographic order of
+ * their evaluation vectors, so the closed labels of a node and the solutions are kept as TruncatedFronts (see
+ * NamoaStarDR); a label is only checked for dominance when it is generated and when it is extracted.
+ *
+ * The search can also run in steps (see resume), so several queries can be interleaved on one thread.
+ */
+class SharedNamoaStar
+{
+public:
+    typedef SharedGraph::WeightType WeightType;
+
+    SharedNamoaStar( const SharedGraph& graph): G(graph), m_numCriteria( graph.getNumCriteria()), m_generatedLabels(0),
+                                                m_step( DONE)
+    {
+        m_closed.resize( G.getNumNodes());
+        m_heuristic.assign( (unsigned long long) G.getNumNodes() * m_numCriteria, unreachable());
+    }
+
+    /**
+     * @brief Runs a query between the nodes with ids s and t
+     *
+     * @param solutions The Pareto efficient costs from s to t, in lexicographic order
+     */
+    void runQuery( const unsigned int& s, const unsigned int& t, std::vector<CriteriaList>& solutions)
+    {
+        start( s, t);
+        while ( resume());
+        solutions = m_solutions;
+    }
+
+    /**
+     * @brief Starts a query between the nodes with ids s and t, computing the heuristic. The search runs in resume
+     */
+    void start( const unsigned int& s, const unsigned int& t)
+    {
+        clear();
+        m_solutions.clear();
+        m_targetFront.clear();
+        m_generatedLabels = 0;
+        m_target = t;
+        m_step = DONE;
+        computeIdealPoint( t);
+        if ( m_heuristic[s * m_numCriteria] == unreachable()) return;
+
+        CriteriaList zero( m_numCriteria);
+        push( zero, s);
+        m_step = EXTRACT;
+    }
+
+    /**
+     * @brief Runs the next step of the query: extracting a label, loading the successors of its node, or relaxing the
+     * outgoing edges of its node. Every step ends prefetching the data of the next one, so the cache misses of a query
+     * are served while other queries run their steps (see InterleavedNamoaStar)
+     *
+     * @return False once the query is done
+     */
+    bool resume()
+    {
+        switch ( m_step)
+        {
+            case EXTRACT:
+                while ( true)
+                {
+                    if ( m_queue.empty())
+                    {
+                        m_step = DONE;
+                        return false;
+                    }
+                    Entry entry = m_queue.top();
+                    m_queue.pop();
+                    const unsigned int u = entry.u;
+                    CriteriaList g_u = entry.f - heuristic( u);
+                    if ( m_closed[u].dominates( g_u) || m_targetFront.dominates( entry.f)) continue;
+                    if ( m_closed[u].empty()) m_touched.push_back( u);
+                    m_closed[u].insert( g_u);
+                    ++m_generatedLabels;
+                    if ( u == m_target)
+                    {
+                        m_targetFront.insert( g_u);
+                        m_solutions.push_back( g_u);
+                        continue;
+                    }
+                    m_u = u;
+                    m_g_u = g_u;
+                    G.prefetchEdges( u);
+                    m_step = LOAD;
+                    return true;
+                }
+            case LOAD:
+                for ( unsigned int e = G.beginEdges( m_u); e != G.endEdges( m_u); ++e)
+                {
+                    const unsigned int v = G.getTarget( e);
+                    __builtin_prefetch( &m_heuristic[v * m_numCriteria]);
+                    __builtin_prefetch( &m_closed[v]);
+                }
+                m_step = RELAX;
+                return true;
+            case RELAX:
+                for ( unsigned int e = G.beginEdges( m_u); e != G.endEdges( m_u); ++e)
+                {
+                    const unsigned int v = G.getTarget( e);
+                    if ( m_heuristic[v * m_numCriteria] == unreachable()) continue;
+                    CriteriaList g_v = m_g_u + cost( e);
+                    if ( m_closed[v].dominates( g_v)) continue;
+                    CriteriaList f_v = g_v + heuristic( v);
+                    if ( m_targetFront.dominates( f_v)) continue;
+                    m_queue.push( Entry( f_v, v));
+                }
+                if ( !m_queue.empty())
+                {
+                    __builtin_prefetch( &m_heuristic[m_queue.top().u * m_numCriteria]);
+                    __builtin_prefetch( &m_closed[m_queue.top().u]);
+                }
+                m_step = EXTRACT;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Returns the Pareto efficient costs found so far, in lexicographic order
+     */
+    const std::vector<CriteriaList>& getSolutions() const
+    {
+        return m_solutions;
+    }
+
+    const unsigned int& getGeneratedLabels() const
+    {
+        return m_generatedLabels;
+    }
+
+private:
+    struct Entry
+    {
+        Entry( const CriteriaList& key, const unsigned int& node): f( key), u( node)
+        {
+        }
+        CriteriaList f;
+        unsigned int u;
+    };
+
+    struct EntryComparator
+    {
+        bool operator()( const Entry& a, const Entry& b) const
+        {
+            return b.f < a.f;
+        }
+    };
+
+    enum Step { EXTRACT, LOAD, RELAX, DONE };
+
+    const SharedGraph& G;
+    unsigned int m_numCriteria;
+    unsigned int m_generatedLabels;
+    Step m_step;
+    unsigned int m_target;
+    unsigned int m_u;                           // node of the last label extracted
+    CriteriaList m_g_u;
+    TruncatedFront m_targetFront;
+    std::vector<CriteriaList> m_solutions;
+    std::vector<TruncatedFront> m_closed;       // [node id]
+    std::vector<WeightType> m_heuristic;        // [node id * criteria + criterion]
+    std::vector<unsigned int> m_touched;        // nodes with closed labels
+    std::vector<unsigned int> m_reached;        // nodes with a heuristic
+    std::priority_queue< Entry, std::vector<Entry>, EntryComparator> m_queue;
+
+    static WeightType unreachable()
+    {
+        return std::numeric_limits<WeightType>::max();
+    }
+
+    void push( const CriteriaList& g, const unsigned int& u)
+    {
+        m_queue.push( Entry( g + heuristic( u), u));
+    }
+
+    CriteriaList heuristic( const unsigned int& u) const
+    {
+        return CriteriaList( std::vector<WeightType>( m_heuristic.begin() + u * m_numCriteria, m_heuristic.begin() + ( u + 1) * m_numCriteria));
+    }
+
+    CriteriaList cost( const unsigned int& e) const
+    {
+        const WeightType* c = G.getCost( e);
+        return CriteriaList( std::vector<WeightType>( c, c + m_numCriteria));
+    }
+
+    void clear()
+    {
+        for ( unsigned int i = 0; i < m_touched.size(); ++i)
+        {
+            m_closed[m_touched[i]].clear();
+        }
+        m_touched.clear();
+        for ( unsigned int i = 0; i < m_reached.size(); ++i)
+        {
+            std::fill( m_heuristic.begin() + m_reached[i] * m_numCriteria, m_heuristic.begin() + ( m_reached[i] + 1) * m_numCriteria, unreachable());
+        }
+        m_reached.clear();
+        while ( !m_queue.empty()) m_queue.pop();
+    }
+
+    /**
+     * @brief Computes the distance of every node to t on every criterion, by a backward search per criterion
+     */
+    void computeIdealPoint( const unsigned int& t)
+    {
+        typedef std::pair<WeightType, unsigned int> Item;
+        for ( unsigned int k = 0; k < m_numCriteria; ++k)
+        {
+            std::priority_queue< Item, std::vector<Item>, std::greater<Item> > queue;
+            m_heuristic[t * m_numCriteria + k] = 0;
+            if ( k == 0) m_reached.push_back( t);
+            queue.push( Item( 0, t));
+            while ( !queue.empty())
+            {
+                Item item = queue.top();
+                queue.pop();
+                const unsigned int v = item.second;
+                if ( item.first > m_heuristic[v * m_numCriteria + k]) continue;
+                for ( unsigned int i = G.beginInEdges( v); i != G.endInEdges( v); ++i)
+                {
+                    const unsigned int e = G.getInEdge( i);
+                    const unsigned int u = G.getSource( e);
+                    WeightType distance = item.first + G.getCost( e)[k];
+                    WeightType& h_u = m_heuristic[u * m_numCriteria + k];
+                    if ( distance < h_u)
+                    {
+                        // every criterion reaches the same nodes, so the first one records them
+                        if ( ( k == 0) && ( h_u == unreachable())) m_reached.push_back( u);
+                        h_u = distance;
+                        queue.push( Item( distance, u));
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @class InterleavedNamoaStar
+ *
+ * @brief Runs several SharedNamoaStar queries on one thread, taking a step of each one in turn
+ *
+ * Every step ends prefetching what the next step of its query reads, so the cache misses of a query overlap with the
+ * work of the others. Every slot owns a SharedNamoaStar, i.e. a heuristic and closed sets for the whole graph.
+ */
+class InterleavedNamoaStar
+{
+public:
+    struct Slot
+    {
+        std::unique_ptr<SharedNamoaStar> search;
+        std::pair<unsigned int,unsigned int> query;
+        unsigned int position;      // set by the caller with the query
+        Timer timer;                // started with the query
+        bool isActive;
+    };
+
+    InterleavedNamoaStar( const SharedGraph& graph, const unsigned int& numSlots): m_slots( std::max( numSlots, 1u))
+    {
+        for ( unsigned int i = 0; i < m_slots.size(); ++i)
+        {
+            m_slots[i].search.reset( new SharedNamoaStar( graph));
+            m_slots[i].isActive = false;
+        }
+    }
+
+    unsigned int getNumSlots() const
+    {
+        return m_slots.size();
+    }
+
+    /**
+     * @brief Runs the queries given by next until it returns false, and passes every slot to report once its query is
+     * done
+     *
+     * @param next Sets the query of a free slot, waiting for it if needed. It returns false once there are no more
+     * queries. Only called when no query runs
+     * @param tryNext Sets the query of a free slot if one is available right away, and returns false otherwise. Called
+     * while other queries run, at most every 256 rounds unless a query ended, so it must not block them
+     */
+    void run( const std::function<bool( Slot&)>& next, const std::function<bool( Slot&)>& tryNext,
+              const std::function<void( Slot&)>& report)
+    {
+        unsigned int numActive = 0, round = 0;
+        bool hasMore = true;
+        while ( true)
+        {
+            if ( hasMore && ( numActive < m_slots.size()) && ( ( numActive == 0) || ( ++round % 256 == 0)))
+            {
+                for ( unsigned int i = 0; ( i < m_slots.size()) && hasMore; ++i)
+                {
+                    Slot& slot = m_slots[i];
+                    if ( slot.isActive) continue;
+                    if ( numActive > 0)
+                    {
+                        // the end of the queries is only known once the running ones are done
+                        if ( !( tryNext( slot))) break;
+                    }
+                    else if ( !( next( slot)))
+                    {
+                        hasMore = false;
+                        break;
+                    }
+                    slot.timer.start();
+                    slot.search->start( slot.query.first, slot.query.second);
+                    slot.isActive = true;
+                    ++numActive;
+                }
+                round = 0;
+            }
+            if ( numActive == 0)
+            {
+                if ( !hasMore) return;
+                continue;
+            }
+            for ( unsigned int i = 0; i < m_slots.size(); ++i)
+            {
+                Slot& slot = m_slots[i];
+                if ( !slot.isActive || slot.search->resume()) continue;
+                slot.isActive = false;
+                --numActive;
+                report( slot);
+                round = 255;
+            }
+        }
+    }
+
+private:
+    std::vector<Slot> m_slots;
+};
+
+#endif // SHAREDNAMOASTAR_H
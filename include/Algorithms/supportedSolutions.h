@@ -0,0 +1,296 @@
+#ifndef SUPPORTEDSOLUTIONS_H
+#define SUPPORTEDSOLUTIONS_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <algorithm>
+#include <queue>
+
+/**
+ * @class SupportedSolutions
+ *
+ * @brief Prepass finding some Pareto efficient solutions of a query with scalar Dijkstra searches
+ *
+ * Every search minimizes a weighted sum of the criteria and breaks ties in lexicographic order, so the path it finds
+ * is Pareto efficient. The first searches weight a single criterion each and give the lexicographic optima, the
+ * extremes of the front. For two criteria, the next ones weight the criteria by the slope between two neighbouring
+ * solutions found so far (dichotomic search), and stop when no new supported solution lies between them. For more
+ * criteria a single search weights all the criteria equally.
+ *
+ * The componentwise maximum of the lexicographic optima is the nadir point of the front for two criteria, and a
+ * lower estimate of it otherwise.
+ *
+ * The state of the searches is kept in arrays indexed by node id, so the node data used by the multicriteria
+ * searches is left untouched.
+ *
+ * @tparam GraphType The type of the graph to run the searches on
+ */
+template<class GraphType>
+class SupportedSolutions
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef CriteriaList::WeightType            WeightType;
+
+    SupportedSolutions( GraphType& graph, unsigned int numCriteria): G(graph), m_numCriteria(numCriteria), m_maxSearches(0)
+    {
+    }
+
+    /**
+     * @brief Sets the largest number of searches run by a query, 0 (the default) for no limit. The lexicographic
+     * optima are always computed
+     */
+    void setMaxSearches( const unsigned int& maxSearches)
+    {
+        m_maxSearches = maxSearches;
+    }
+
+    /**
+     * @brief Finds the solutions of a query from s to t. There are none when t cannot be reached
+     */
+    void run( const NodeIterator& s, const NodeIterator& t)
+    {
+        clear();
+        std::vector<unsigned int> weights( m_numCriteria, 0);
+        for ( unsigned int i = 0; i < m_numCriteria; ++i)
+        {
+            weights[i] = 1;
+            if ( !( search( s, t, weights))) return;
+            weights[i] = 0;
+        }
+        for ( unsigned int i = 0; i < m_costs.size(); ++i)
+        {
+            for ( unsigned int j = 0; j < m_numCriteria; ++j)
+            {
+                m_nadir[j] = std::max( m_nadir[j], m_costs[i][j]);
+            }
+        }
+        if ( m_numCriteria == 2)
+        {
+            // the solutions are sorted by the first criterion, the second one decreases
+            std::vector<unsigned int> order( m_costs.size());
+            for ( unsigned int i = 0; i < order.size(); ++i) order[i] = i;
+            sortByCosts( order);
+            if ( order.size() == 2) splitSegment( s, t, order[1], order[0]);
+        }
+        else if ( !isLimitReached())
+        {
+            search( s, t, std::vector<unsigned int>( m_numCriteria, 1));
+        }
+    }
+
+    /**
+     * @brief Runs a single search from s to t minimizing the weighted sum of the criteria, with ties broken in
+     * lexicographic order. Its solution replaces the ones of the last query. The graph is only read, so several
+     * objects can run searches on the same graph at the same time
+     *
+     * @return False if t cannot be reached
+     */
+    bool runWeighted( const NodeIterator& s, const NodeIterator& t, const std::vector<unsigned int>& weights)
+    {
+        clear();
+        return search( s, t, weights);
+    }
+
+    /**
+     * @brief Returns the number of distinct solutions found by the last query
+     */
+    unsigned int size() const
+    {
+        return m_costs.size();
+    }
+
+    const CriteriaList& getCosts( const unsigned int& i) const
+    {
+        return m_costs[i];
+    }
+
+    /**
+     * @brief Returns the ids of the nodes of the path of a solution, from s to t
+     */
+    const std::vector<unsigned int>& getPath( const unsigned int& i) const
+    {
+        return m_paths[i];
+    }
+
+    const CriteriaList& getNadir() const
+    {
+        return m_nadir;
+    }
+
+private:
+    enum { NONE = 0xFFFFFFFF };
+    enum State { UNREACHED, REACHED, SETTLED };
+
+    struct Entry
+    {
+        unsigned long long sum;
+        CriteriaList cost;
+        unsigned int u;
+    };
+
+    struct EntryComparator
+    {
+        bool operator()( const Entry& a, const Entry& b) const
+        {
+            return ( b.sum < a.sum) || ( ( b.sum == a.sum) && ( b.cost < a.cost));
+        }
+    };
+
+    GraphType& G;
+    unsigned int m_numCriteria;
+    unsigned int m_maxSearches, m_numSearches;
+    std::vector<NodeIterator> m_nodesById;
+    std::vector<WeightType> m_cost;                 // [node id * criteria + criterion]
+    std::vector<unsigned int> m_pred;               // [node id]
+    std::vector<char> m_state;                      // [node id]
+    std::vector<unsigned int> m_touched;
+    std::vector<CriteriaList> m_costs;
+    std::vector< std::vector<unsigned int> > m_paths;
+    CriteriaList m_nadir;
+
+    void clear()
+    {
+        m_costs.clear();
+        m_paths.clear();
+        m_nadir = CriteriaList( m_numCriteria);
+        m_numSearches = 0;
+        if ( m_nodesById.empty())
+        {
+            NodeIterator u, lastNode;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+            {
+                if ( u->id >= m_nodesById.size()) m_nodesById.resize( u->id + 1);
+                m_nodesById[u->id] = u;
+            }
+            m_cost.assign( m_nodesById.size() * m_numCriteria, 0);
+            m_pred.assign( m_nodesById.size(), NONE);
+            m_state.assign( m_nodesById.size(), UNREACHED);
+        }
+    }
+
+    bool isLimitReached() const
+    {
+        return ( m_maxSearches > 0) && ( m_numSearches >= std::max( m_maxSearches, m_numCriteria));
+    }
+
+    void sortByCosts( std::vector<unsigned int>& order) const
+    {
+        std::sort( order.begin(), order.end(), [this]( unsigned int a, unsigned int b) { return m_costs[a] < m_costs[b]; });
+        order.erase( std::unique( order.begin(), order.end(), [this]( unsigned int a, unsigned int b) { return m_costs[a] == m_costs[b]; }), order.end());
+    }
+
+    /**
+     * @brief Dichotomic search between two solutions a and b, a with the smaller second criterion. A supported
+     * solution strictly below the segment from a to b splits it in two
+     */
+    void splitSegment( const NodeIterator& s, const NodeIterator& t, const unsigned int& a, const unsigned int& b)
+    {
+        if ( isLimitReached()) return;
+        const CriteriaList costA = m_costs[a];
+        const CriteriaList costB = m_costs[b];
+        if ( ( costA[0] <= costB[0]) || ( costB[1] <= costA[1])) return;
+        std::vector<unsigned int> weights( 2);
+        weights[0] = costB[1] - costA[1];
+        weights[1] = costA[0] - costB[0];
+        unsigned int before = m_costs.size();
+        search( s, t, weights);
+        if ( m_costs.size() == before) return;
+        unsigned int c = before;
+        unsigned long long sumA = (unsigned long long) weights[0] * costA[0] + (unsigned long long) weights[1] * costA[1];
+        unsigned long long sumC = (unsigned long long) weights[0] * m_costs[c][0] + (unsigned long long) weights[1] * m_costs[c][1];
+        if ( sumC >= sumA) return;
+        splitSegment( s, t, a, c);
+        splitSegment( s, t, c, b);
+    }
+
+    /**
+     * @brief Finds a path from s to t minimizing the weighted sum of its criteria, with ties broken in lexicographic
+     * order, and stores it unless an equal solution is known
+     *
+     * @return False if t is not reachable
+     */
+    bool search( const NodeIterator& s, const NodeIterator& t, const std::vector<unsigned int>& weights)
+    {
+        ++m_numSearches;
+        for ( unsigned int i = 0; i < m_touched.size(); ++i)
+        {
+            m_state[m_touched[i]] = UNREACHED;
+        }
+        m_touched.clear();
+
+        std::priority_queue< Entry, std::vector<Entry>, EntryComparator> queue;
+        Entry entry;
+        entry.sum = 0;
+        entry.cost = CriteriaList( m_numCriteria);
+        entry.u = s->id;
+        setCost( s->id, entry.cost, NONE);
+        queue.push( entry);
+        while ( !queue.empty())
+        {
+            entry = queue.top();
+            queue.pop();
+            const unsigned int u = entry.u;
+            if ( ( m_state[u] == SETTLED) || !( entry.cost == getCost( u))) continue;
+            m_state[u] = SETTLED;
+            if ( u == t->id) break;
+            NodeIterator node = m_nodesById[u];
+            EdgeIterator e, lastEdge;
+            for( e = G.beginEdges( node), lastEdge = G.endEdges( node); e != lastEdge; ++e)
+            {
+                const unsigned int v = G.target(e)->id;
+                if ( m_state[v] == SETTLED) continue;
+                Entry next;
+                next.cost = entry.cost + e->criteriaList;
+                next.sum = 0;
+                for ( unsigned int j = 0; j < m_numCriteria; ++j)
+                {
+                    next.sum += (unsigned long long) weights[j] * next.cost[j];
+                }
+                if ( m_state[v] == REACHED)
+                {
+                    unsigned long long sum = 0;
+                    CriteriaList cost = getCost( v);
+                    for ( unsigned int j = 0; j < m_numCriteria; ++j)
+                    {
+                        sum += (unsigned long long) weights[j] * cost[j];
+                    }
+                    if ( ( sum < next.sum) || ( ( sum == next.sum) && !( next.cost < cost))) continue;
+                }
+                next.u = v;
+                setCost( v, next.cost, u);
+                queue.push( next);
+            }
+        }
+        if ( m_state[t->id] != SETTLED) return false;
+
+        CriteriaList cost = getCost( t->id);
+        for ( unsigned int i = 0; i < m_costs.size(); ++i)
+        {
+            if ( m_costs[i] == cost) return true;
+        }
+        m_costs.push_back( cost);
+        m_paths.push_back( std::vector<unsigned int>());
+        for ( unsigned int v = t->id; v != NONE; v = m_pred[v])
+        {
+            m_paths.back().push_back( v);
+        }
+        std::reverse( m_paths.back().begin(), m_paths.back().end());
+        return true;
+    }
+
+    void setCost( const unsigned int& v, const CriteriaList& cost, const unsigned int& pred)
+    {
+        if ( m_state[v] == UNREACHED) m_touched.push_back( v);
+        m_state[v] = REACHED;
+        m_pred[v] = pred;
+        std::copy( &cost[0], &cost[0] + m_numCriteria, m_cost.begin() + v * m_numCriteria);
+    }
+
+    CriteriaList getCost( const unsigned int& v) const
+    {
+        return CriteriaList( std::vector<WeightType>( m_cost.begin() + v * m_numCriteria, m_cost.begin() + ( v + 1) * m_numCriteria));
+    }
+};
+
+#endif // SUPPORTEDSOLUTIONS_H
@@ -0,0 +1,307 @@
+#ifndef TWOPHASESEARCH_H
+#define TWOPHASESEARCH_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <Algorithms/supportedSolutions.h>
+#include <Utilities/threadPool.h>
+#include <limits>
+#include <memory>
+#include <queue>
+
+/**
+ * @class TwoPhaseSearch
+ *
+ * @brief Parallel two-phase exact search for graphs with edges labeled with two criteria
+ *
+ * The first phase finds the supported solutions, i.e. the extreme points of the convex hull of the front, by a
+ * dichotomic search over the weights of scalar Dijkstra searches (see SupportedSolutions). Every round splits all the
+ * open segments between neighbouring supported solutions at once, one search per thread.
+ *
+ * The other efficient solutions lie in the triangles between neighbouring supported solutions a and b, so the second
+ * phase runs one label setting search per triangle, concurrently. A search extracts its labels in lexicographic order
+ * of their evaluation vectors (f), like NamoaStarDR, and prunes every label whose f is not strictly below the second
+ * criterion of a and the first criterion of b. These searches are small and independent, which parallelizes far
+ * better than a single NAMOA* search over the whole front.
+ *
+ * With other numbers of criteria there are no triangles, and a single unbounded search runs on the calling thread.
+ *
+ * The Pareto efficient solutions are stored in G_cl(t) in lexicographic order, without paths.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @tparam HeuristicGraphType The heuristic engine computing the (consistent) heuristicList of the nodes
+ */
+template<class GraphType, template <typename graphType> class HeuristicGraphType>
+class TwoPhaseSearch
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef CriteriaList::WeightType            WeightType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     */
+    TwoPhaseSearch( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+                    G(graph), m_numCriteria(numCriteria), m_timestamp(timestamp), m_heuristicEngine(graph),
+                    m_searches( m_pool.size())
+    {
+        NodeIterator u,lastNode;
+        unsigned int maxId = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id > maxId) maxId = u->id;
+        }
+        for ( unsigned int i = 0; i < m_searches.size(); ++i)
+        {
+            m_searches[i].closed.resize( maxId + 1);
+            m_searches[i].scalar.reset( new SupportedSolutions<GraphType>( graph, numCriteria));
+        }
+    }
+
+    /**
+     * @brief Sets the approximation factor used to prune with the solutions (see NamoaStar2::setEpsilon). The
+     * supported solutions are always exact
+     */
+    void setEpsilon( const std::vector<double>& epsilon)
+    {
+        assert( epsilon.empty() || epsilon.size() == m_numCriteria);
+        m_epsilon = epsilon;
+    }
+
+    void init(const NodeIterator& s, const NodeIterator& t, const unsigned int nCriteria)
+    {
+        m_heuristicEngine.init( s, t, nCriteria);
+    }
+
+    /**
+     * @brief Runs a query between a source node s and a target node t. The solutions are stored in G_cl(t)
+     *
+     * @param s The source node
+     * @param t The target node
+     */
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    {
+        ++(*m_timestamp);
+        m_expandedLabels = 0;
+        std::vector<CriteriaList> solutions;
+        if ( m_numCriteria == 2)
+        {
+            findSupportedSolutions( s, t, solutions);
+            if ( solutions.size() > 1)
+            {
+                std::vector< std::vector<CriteriaList> > found( solutions.size() - 1);
+                m_pool.parallelFor( found.size(), [&]( unsigned int i, unsigned int thread)
+                {
+                    search( m_searches[thread], s, t, &solutions[i], &solutions[i + 1], found[i]);
+                });
+                for ( unsigned int i = 0; i < found.size(); ++i)
+                {
+                    solutions.insert( solutions.end(), found[i].begin(), found[i].end());
+                }
+                std::sort( solutions.begin(), solutions.end());
+            }
+        }
+        else
+        {
+            search( m_searches[0], s, t, 0, 0, solutions);
+        }
+
+        t->g_cl.clear();
+        for ( unsigned int i = 0; i < solutions.size(); ++i)
+        {
+            t->g_cl.push_back( Label( solutions[i], t->getDescriptor(), 0));
+        }
+        m_generatedLabels = m_expandedLabels;
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+private:
+    struct Entry
+    {
+        Entry( const CriteriaList& key, const NodeIterator& node): f( key), u( node)
+        {
+        }
+        CriteriaList f;
+        NodeIterator u;
+    };
+
+    struct EntryComparator
+    {
+        bool operator()( const Entry& a, const Entry& b) const
+        {
+            return b.f < a.f;
+        }
+    };
+
+    /**
+     * @brief State of the searches run by a thread
+     */
+    struct Search
+    {
+        std::vector<TruncatedFront> closed;     // [node id]
+        std::vector<unsigned int> touched;      // nodes with closed labels
+        std::priority_queue< Entry, std::vector<Entry>, EntryComparator> queue;
+        std::unique_ptr< SupportedSolutions<GraphType> > scalar;
+    };
+
+    typedef std::pair<CriteriaList, CriteriaList> Segment;
+
+    GraphType& G;
+    unsigned int m_numCriteria;
+    unsigned int* m_timestamp;
+    HeuristicGraphType<GraphType> m_heuristicEngine;
+    ThreadPool m_pool;
+    std::vector<Search> m_searches;                 // [thread]
+    std::vector<double> m_epsilon;
+    std::atomic<unsigned int> m_expandedLabels;
+    unsigned int m_generatedLabels;
+
+    static unsigned long long weightedSum( const std::vector<unsigned int>& weights, const CriteriaList& cost)
+    {
+        return (unsigned long long) weights[0] * cost[0] + (unsigned long long) weights[1] * cost[1];
+    }
+
+    /**
+     * @brief Runs a weighted search per entry of weights, in parallel
+     *
+     * @param costs The cost of the solution of every search
+     * @return False if t cannot be reached
+     */
+    bool runScalarSearches( const NodeIterator& s, const NodeIterator& t, const std::vector< std::vector<unsigned int> >& weights,
+                            std::vector<CriteriaList>& costs)
+    {
+        costs.assign( weights.size(), CriteriaList( m_numCriteria));
+        std::vector<char> reached( weights.size(), 0);
+        m_pool.parallelFor( weights.size(), [&]( unsigned int i, unsigned int thread)
+        {
+            SupportedSolutions<GraphType>& scalar = *(m_searches[thread].scalar);
+            if ( !( scalar.runWeighted( s, t, weights[i]))) return;
+            costs[i] = scalar.getCosts( 0);
+            reached[i] = 1;
+        });
+        return std::find( reached.begin(), reached.end(), 0) == reached.end();
+    }
+
+    /**
+     * @brief Finds the supported solutions by a dichotomic search, splitting all the open segments of a round in
+     * parallel
+     *
+     * @param solutions The supported solutions, in lexicographic order. Empty if t cannot be reached
+     */
+    void findSupportedSolutions( const NodeIterator& s, const NodeIterator& t, std::vector<CriteriaList>& solutions)
+    {
+        std::vector< std::vector<unsigned int> > weights( 2, std::vector<unsigned int>( 2, 0));
+        weights[0][0] = 1;
+        weights[1][1] = 1;
+        if ( !( runScalarSearches( s, t, weights, solutions)))
+        {
+            solutions.clear();
+            return;
+        }
+        std::sort( solutions.begin(), solutions.end());
+        solutions.erase( std::unique( solutions.begin(), solutions.end()), solutions.end());
+
+        std::vector<Segment> segments;
+        if ( solutions.size() == 2) segments.push_back( Segment( solutions[0], solutions[1]));
+        while ( !segments.empty())
+        {
+            // the weights are normal to the segment, so a solution strictly below it has a smaller weighted sum
+            weights.assign( segments.size(), std::vector<unsigned int>( 2));
+            for ( unsigned int i = 0; i < segments.size(); ++i)
+            {
+                weights[i][0] = segments[i].first[1] - segments[i].second[1];
+                weights[i][1] = segments[i].second[0] - segments[i].first[0];
+            }
+            std::vector<CriteriaList> costs;
+            runScalarSearches( s, t, weights, costs);
+            std::vector<Segment> next;
+            for ( unsigned int i = 0; i < segments.size(); ++i)
+            {
+                if ( weightedSum( weights[i], costs[i]) >= weightedSum( weights[i], segments[i].first)) continue;
+                solutions.push_back( costs[i]);
+                next.push_back( Segment( segments[i].first, costs[i]));
+                next.push_back( Segment( costs[i], segments[i].second));
+            }
+            segments.swap( next);
+        }
+        std::sort( solutions.begin(), solutions.end());
+    }
+
+    /**
+     * @brief Checks whether a label cannot lead to a new solution: its evaluation vector is not strictly inside the
+     * triangle from a to b, or it is dominated by a solution
+     */
+    bool isPruned( const TruncatedFront& front, const CriteriaList& f, const CriteriaList* a, const CriteriaList* b) const
+    {
+        if ( ( a != 0) && ( ( f[0] >= (*b)[0]) || ( f[1] >= (*a)[1]))) return true;
+        if ( m_epsilon.empty()) return front.dominates( f);
+        CriteriaList bound = f.inflate( m_epsilon);
+        return front.dominates( bound) || ( ( a != 0) && ( a->dominates( bound) || b->dominates( bound)));
+    }
+
+    /**
+     * @brief Label setting search from s to t. With two solutions a and b, it only finds the solutions strictly
+     * inside the triangle between them
+     *
+     * @param solutions The solutions found, in lexicographic order
+     */
+    void search( Search& search, const NodeIterator& s, const NodeIterator& t, const CriteriaList* a, const CriteriaList* b,
+                 std::vector<CriteriaList>& solutions)
+    {
+        EdgeIterator e,lastEdge;
+        for ( unsigned int i = 0; i < search.touched.size(); ++i)
+        {
+            search.closed[search.touched[i]].clear();
+        }
+        search.touched.clear();
+        while ( !search.queue.empty()) search.queue.pop();
+
+        TruncatedFront front;
+        unsigned int expandedLabels = 0;
+        CriteriaList zero( m_numCriteria);
+        if ( !isPruned( front, zero + s->heuristicList, a, b))
+        {
+            search.queue.push( Entry( zero + s->heuristicList, s));
+        }
+        while ( !search.queue.empty())
+        {
+            Entry entry = search.queue.top();
+            search.queue.pop();
+            const NodeIterator u = entry.u;
+            CriteriaList g_u = entry.f - u->heuristicList;
+            TruncatedFront& closed = search.closed[u->id];
+            if ( closed.dominates( g_u) || isPruned( front, entry.f, a, b)) continue;
+            if ( closed.empty()) search.touched.push_back( u->id);
+            closed.insert( g_u);
+            ++expandedLabels;
+            if ( u == t)
+            {
+                front.insert( g_u);
+                solutions.push_back( g_u);
+                continue;
+            }
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                NodeIterator v = G.target(e);
+                if ( v->heuristicList[0] == std::numeric_limits<WeightType>::max()) continue;
+                CriteriaList g_v = g_u + e->criteriaList;
+                if ( search.closed[v->id].dominates( g_v)) continue;
+                CriteriaList f_v = g_v + v->heuristicList;
+                if ( isPruned( front, f_v, a, b)) continue;
+                search.queue.push( Entry( f_v, v));
+            }
+        }
+        m_expandedLabels += expandedLabels;
+    }
+};
+
+#endif // TWOPHASESEARCH_H
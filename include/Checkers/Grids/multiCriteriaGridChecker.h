@@ -110,7 +110,7 @@ private:
             data.str(token);
             data >> nprobs;
             unsigned int counter = nprobs;
-            assert(nprobs == m_nqueries);
+            assert(nprobs <= m_nqueries);
             // rest
             while (counter > 0 && getline(in, token))
             {
@@ -154,9 +154,11 @@ private:
             unsigned int counter = nprobs;
 
             // read problem source and target coordinates
-            getline(in, token); // discard the comment on the first line
-            while (counter > 0 && getline(in, token))
+            getline(in, token); // discard the comment on the first line, if any
+            bool pendingLine = !token.empty() && token[0] != '%';
+            while (counter > 0 && (pendingLine || getline(in, token)))
             {
+                pendingLine = false;
                 data.str(token);
                 data >> prob_n;
                 data >> nCriteria;
@@ -182,13 +184,13 @@ private:
                     CriteriaList solution( paretoSolution);
                     query_solutions.push_back(solution);
                 }
+                // the queries run are generated by getQueries, so the solution is kept even if the queries file
+                // does not list the problem
                 auto it = m_queries.find(prob_n);
-                if (it != m_queries.end())
-                {
-                    std::pair<unsigned int, std::vector<CriteriaList> > solution(prob_n, query_solutions);
-                    m_solutions.insert(solution);
-                }
-                else std::cerr << "Found solution to a query not specified, n: " << prob_n << std::endl;
+                if (it == m_queries.end())
+                    std::cerr << "Found solution to a query not specified, n: " << prob_n << std::endl;
+                std::pair<unsigned int, std::vector<CriteriaList> > solution(prob_n, query_solutions);
+                m_solutions.insert(solution);
 
                 query_solutions.clear();
                 ++cont;
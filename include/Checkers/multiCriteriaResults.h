@@ -51,8 +51,67 @@ public:
         return false;
     }
 
+    /**
+     * @brief Checks an approximated set of solutions: every Pareto efficient cost must be (1+epsilon)-dominated by a
+     * solution found, and the solutions found must be distinct and not dominate each other. The checker only knows
+     * the costs, so a solution found is only rejected as infeasible if it lies below the Pareto front, which no path
+     * does
+     */
+    bool checkEpsilonCovering(MultiCriteriaChecker& checker, unsigned int query_n, const std::vector<double>& epsilon)
+    {
+        const std::vector<CriteriaList>& correctSolutions = checker.getSolutions(query_n);
+
+        for (std::vector<CriteriaList>::const_iterator it = correctSolutions.begin(); it != correctSolutions.end(); ++it)
+        {
+            if (!(isCovered(*it, m_paretoSolutions, epsilon))) return false;
+        }
+        for (unsigned int i = 0; i < m_paretoSolutions.size(); ++i)
+        {
+            for (unsigned int j = 0; j < m_paretoSolutions.size(); ++j)
+            {
+                if ((i != j) && m_paretoSolutions[i].dominates(m_paretoSolutions[j])) return false;
+            }
+            if (!(isCovered(m_paretoSolutions[i], correctSolutions, std::vector<double>()))) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks the solutions of a query stopped by its limits: the solutions found must pass the same checks as
+     * in checkEpsilonCovering, and every Pareto efficient cost they do not cover must be bounded from below by the
+     * frontier of the query
+     */
+    bool checkPartialCosts(MultiCriteriaChecker& checker, unsigned int query_n, const std::vector<CriteriaList>& frontier,
+                           const std::vector<double>& epsilon)
+    {
+        const std::vector<CriteriaList>& correctSolutions = checker.getSolutions(query_n);
+
+        for (std::vector<CriteriaList>::const_iterator it = correctSolutions.begin(); it != correctSolutions.end(); ++it)
+        {
+            if (!(isCovered(*it, m_paretoSolutions, epsilon)) && !(isCovered(*it, frontier, std::vector<double>()))) return false;
+        }
+        for (unsigned int i = 0; i < m_paretoSolutions.size(); ++i)
+        {
+            for (unsigned int j = 0; j < m_paretoSolutions.size(); ++j)
+            {
+                if ((i != j) && m_paretoSolutions[i].dominates(m_paretoSolutions[j])) return false;
+            }
+            if (!(isCovered(m_paretoSolutions[i], correctSolutions, std::vector<double>()))) return false;
+        }
+        return true;
+    }
+
 private:
 
+    static bool isCovered(const CriteriaList& solution, const std::vector<CriteriaList>& solutions, const std::vector<double>& epsilon)
+    {
+        for (std::vector<CriteriaList>::const_iterator it = solutions.begin(); it != solutions.end(); ++it)
+        {
+            if (it->epsilonDominates(solution, epsilon)) return true;
+        }
+        return false;
+    }
+
     //std::vector< std::string> m_headers;
     //std::vector< std::vector<double> > m_data;
     const Queries& m_queries;
@@ -0,0 +1,96 @@
+#ifndef GEOMETRIC_H
+#define GEOMETRIC_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <Heuristics/heuristic.h>
+#include <Utilities/geographic.h>
+#include <limits>
+
+/**
+ * @class GeometricHeuristic
+ *
+ * @brief Heuristic engine computing the lower bounds directly from the node coordinates
+ *
+ * For every criterion i the engine keeps the ratio r_i = min_e c_i(e) / d(e), where d(e) is the euclidean length of
+ * the edge. For a length criterion r_i is the scale between the coordinates and the edge lengths, and for a travel time
+ * criterion it is the inverse of the maximum speed found in the graph. Since the euclidean distance is a metric, every
+ * path from u to t costs at least r_i * d(u,t) on criterion i, and r_i * d(u,v) <= c_i(u,v) makes the bound consistent.
+ *
+ * The ratios are calibrated once, the first time the engine is used. After that, no search is needed to initialize a
+ * query; the bounds of every node are evaluated from the coordinates of the node and the target.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class GeometricHeuristic
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+
+    GeometricHeuristic( GraphType& graph):G(graph)
+    {
+    }
+
+    void init( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t, const unsigned int nCriteria)
+    {
+        NodeIterator u,lastNode;
+        if ( m_ratios.size() != nCriteria)
+        {
+            calibrate( nCriteria);
+        }
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            double distance = euclideanDistance( u->x, u->y, t->x, t->y);
+            for (unsigned int i = 0; i < nCriteria; ++i)
+            {
+                u->heuristicList[i] = (unsigned int) floor( m_ratios[i] * distance);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the ratio between the cost and the euclidean length of the cheapest edge for a criterion
+     */
+    const double& getRatio( const unsigned int& criterionIndex) const
+    {
+        return m_ratios[criterionIndex];
+    }
+
+private:
+    GraphType& G;
+    std::vector<double> m_ratios;
+
+    void calibrate( const unsigned int nCriteria)
+    {
+        NodeIterator u,v,lastNode;
+        EdgeIterator e,lastEdge;
+        m_ratios.assign( nCriteria, std::numeric_limits<double>::max());
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                double length = euclideanDistance( u->x, u->y, v->x, v->y);
+                if ( length <= 0) continue;
+                for (unsigned int i = 0; i < nCriteria; ++i)
+                {
+                    double ratio = e->criteriaList[i] / length;
+                    if ( ratio < m_ratios[i]) m_ratios[i] = ratio;
+                }
+            }
+        }
+        for (unsigned int i = 0; i < nCriteria; ++i)
+        {
+            if ( m_ratios[i] == std::numeric_limits<double>::max())
+            {
+                // no edge has a positive length: the coordinates do not bound this criterion
+                m_ratios[i] = 0;
+            }
+            // keep the bounds admissible under floating point rounding
+            m_ratios[i] *= 1 - 1e-9;
+        }
+    }
+};
+
+#endif // GEOMETRIC_H
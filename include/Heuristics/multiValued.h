@@ -0,0 +1,194 @@
+#ifndef MULTIVALUED_H
+#define MULTIVALUED_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/multicriteriaGraph.h>
+#include <Heuristics/heuristic.h>
+#include <Heuristics/ideal.h>
+#include <algorithm>
+
+/**
+ * @class MultiValuedHeuristic
+ *
+ * @brief Heuristic engine attaching a small set of lower-bound vectors to every node
+ *
+ * The ideal point of every node is computed first (see TCHeuristic) and stored in heuristicList, which is still the
+ * potential used to order the search. Then a bounded backward multicriteria search is run from the target. Every label
+ * settled by that search is an exact Pareto cost towards the target, and every label that is not settled yet is
+ * lexicographically greater than the minimum key left in the queue. Hence, for a node u:
+ *
+ *      H(u) = { settled labels of u } U { (max(h_1(u), m_1), h_2(u), ..., h_k(u)) }
+ *
+ * where m is the minimum key left in the queue, is a valid set of lower bounds: every path from u to t costs at least
+ * as much as some vector of H(u). H(u) is stored in heuristicSet and kept under a maximum size by replacing pairs of
+ * vectors by their componentwise minimum, which is still a lower bound of both. An empty heuristicSet means that only
+ * the ideal point is known for the node.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ */
+template<class GraphType>
+class MultiValuedHeuristic
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+    typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage>   PriorityQueueType;
+
+    MultiValuedHeuristic( GraphType& graph):G(graph), m_idealPoint(graph), m_labelBudget(graph.getNumNodes()), m_maxSetSize(8)
+    {
+    }
+
+    void init( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t, const unsigned int nCriteria)
+    {
+        NodeIterator u,lastNode;
+        m_idealPoint.init( s, t, nCriteria);
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            u->heuristicSet.clear();
+        }
+        buildBoundedSets( t, nCriteria);
+
+        CriteriaList residual;
+        bool exhausted = pq.empty();
+        if ( !exhausted)
+        {
+            residual = pq.minKey();
+        }
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( !exhausted)
+            {
+                addResidualBound( u, residual[0]);
+            }
+            compact( u);
+        }
+        pq.clear();
+    }
+
+    /**
+     * @brief Sets the maximum number of labels settled by the backward multicriteria search
+     */
+    void setLabelBudget( const unsigned int& budget)
+    {
+        m_labelBudget = budget;
+    }
+
+    /**
+     * @brief Sets the maximum number of lower-bound vectors stored per node
+     */
+    void setMaxSetSize( const unsigned int& size)
+    {
+        assert( size > 0);
+        m_maxSetSize = size;
+    }
+
+private:
+    GraphType& G;
+    TCHeuristic<GraphType> m_idealPoint;
+    PriorityQueueType pq;
+    unsigned int m_labelBudget;
+    unsigned int m_maxSetSize;
+
+    void buildBoundedSets( const NodeIterator& t, const unsigned int nCriteria)
+    {
+        NodeIterator u,v;
+        InEdgeIterator k,lastInEdge;
+        unsigned int settled = 0;
+
+        pq.clear();
+        pq.insert( CriteriaList( nCriteria), t);
+        while( !pq.empty() && settled < m_labelBudget)
+        {
+            CriteriaList label = pq.minKey();
+            u = pq.minItem();
+            pq.popMin();
+            if ( isDominatedBySet( u, label)) continue;
+            // labels are settled in lexicographic order, so the set of u stays sorted
+            u->heuristicSet.push_back( label);
+            ++settled;
+            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+            {
+                v = G.source(k);
+                CriteriaList newLabel = label + k->criteriaList;
+                if ( isDominatedBySet( v, newLabel)) continue;
+                pq.insert( newLabel, v);
+            }
+        }
+    }
+
+    bool isDominatedBySet( const NodeIterator& u, const CriteriaList& label)
+    {
+        for ( std::vector<CriteriaList>::iterator it = u->heuristicSet.begin(); it != u->heuristicSet.end(); ++it)
+        {
+            if ( it->dominates( label))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void addResidualBound( const NodeIterator& u, const unsigned int& minFirstCriterion)
+    {
+        if ( minFirstCriterion <= u->heuristicList[0] && u->heuristicSet.empty())
+        {
+            // nothing better than the ideal point is known
+            return;
+        }
+        CriteriaList residual( u->heuristicList);
+        if ( residual[0] < minFirstCriterion)
+        {
+            residual[0] = minFirstCriterion;
+        }
+        if ( isDominatedBySet( u, residual)) return;
+        std::vector<CriteriaList>::iterator it = u->heuristicSet.begin();
+        while ( it != u->heuristicSet.end())
+        {
+            if ( it->isDominatedBy( residual))
+            {
+                it = u->heuristicSet.erase( it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        u->heuristicSet.push_back( residual);
+    }
+
+    void compact( const NodeIterator& u)
+    {
+        std::vector<CriteriaList>& bounds = u->heuristicSet;
+        while ( bounds.size() > m_maxSetSize)
+        {
+            std::sort( bounds.begin(), bounds.end());
+            // merge the two lexicographically adjacent vectors that lose the least when replaced by their minimum
+            unsigned int best = 0;
+            unsigned long long bestLoss = std::numeric_limits<unsigned long long>::max();
+            for ( unsigned int i = 0; i + 1 < bounds.size(); ++i)
+            {
+                unsigned long long loss = 0;
+                for ( unsigned int j = 0; j < bounds[i].size(); ++j)
+                {
+                    loss += (bounds[i][j] > bounds[i+1][j]) ? bounds[i][j] - bounds[i+1][j] : bounds[i+1][j] - bounds[i][j];
+                }
+                if ( loss < bestLoss)
+                {
+                    bestLoss = loss;
+                    best = i;
+                }
+            }
+            for ( unsigned int j = 0; j < bounds[best].size(); ++j)
+            {
+                if ( bounds[best+1][j] < bounds[best][j])
+                {
+                    bounds[best][j] = bounds[best+1][j];
+                }
+            }
+            bounds.erase( bounds.begin() + best + 1);
+        }
+    }
+};
+
+#endif // MULTIVALUED_H
@@ -0,0 +1,261 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class GraphView
+ *
+ * @brief A graph with the nodes, edges and edge data of another graph, and its own copy of the node data
+ *
+ * The search algorithms keep the state of a query in the nodes, so searches running at the same time need their own
+ * nodes, but not their own edges. A view stores a copy of the data of every node in an array, in the order of the
+ * nodes of the base graph, and walks the edges of the base graph, whose data is shared by all the views. The targets
+ * of the outgoing edges and the sources of the incoming edges are kept in arrays parallel to the edge lists, so
+ * following an edge of a view costs no more than in the base graph.
+ *
+ * The view offers the part of the graph interface used by the search algorithms. The nodes and edges of the base graph
+ * must not change while a view of it exists; the data of the edges may.
+ *
+ * @tparam GraphType The type of the base graph
+ */
+template<class GraphType>
+class GraphView
+{
+public:
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::NodeData        NodeData;
+    typedef typename GraphType::EdgeData        EdgeData;
+
+    /**
+     * @brief A node of the view: the data of a node of the base graph and where its edges are
+     */
+    class ViewNode: public NodeData
+    {
+    public:
+        ViewNode( const NodeData& data): NodeData( data)
+        {
+        }
+
+        ViewNode* getDescriptor()
+        {
+            return this;
+        }
+
+    private:
+        friend class GraphView;
+        typename GraphType::NodeIterator m_base;
+        ViewNode** m_targets;   // targets of the outgoing edges, in the order of the edges
+        ViewNode** m_sources;   // sources of the incoming edges, in the order of the edges
+    };
+
+    /**
+     * @brief Iterator over the edges of a base graph iterator type, which knows the node at the other end
+     */
+    template<typename BaseIterator>
+    class AdjacentIterator
+    {
+    public:
+        AdjacentIterator(): m_adjacent(0)
+        {
+        }
+
+        AdjacentIterator( const BaseIterator& edge, ViewNode* const* adjacent): m_edge( edge), m_adjacent( adjacent)
+        {
+        }
+
+        EdgeData& operator*() const
+        {
+            return *m_edge;
+        }
+
+        EdgeData* operator->() const
+        {
+            return &( *m_edge);
+        }
+
+        AdjacentIterator& operator++()
+        {
+            ++m_edge;
+            ++m_adjacent;
+            return *this;
+        }
+
+        bool operator==( const AdjacentIterator& other) const
+        {
+            return m_edge == other.m_edge;
+        }
+
+        bool operator!=( const AdjacentIterator& other) const
+        {
+            return m_edge != other.m_edge;
+        }
+
+    private:
+        friend class GraphView;
+        BaseIterator m_edge;
+        ViewNode* const* m_adjacent;
+    };
+
+    typedef ViewNode*                                                           NodeIterator;
+    typedef ViewNode*                                                           NodeDescriptor;
+    typedef AdjacentIterator<typename GraphType::EdgeIterator>                  EdgeIterator;
+    typedef AdjacentIterator<typename GraphType::InEdgeIterator>                InEdgeIterator;
+
+    /**
+     * @brief Constructor. Copies the data of the nodes of the base graph
+     */
+    GraphView( GraphType& base): G( base)
+    {
+        typename GraphType::NodeIterator u, lastNode;
+        typename GraphType::EdgeIterator e, lastEdge;
+        typename GraphType::InEdgeIterator k, lastInEdge;
+        std::unordered_map<typename GraphType::NodeDescriptor, ViewNode*> nodes;
+        unsigned int numEdges = 0, numInEdges = 0;
+        m_nodes.reserve( G.getNumNodes());
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            m_nodes.push_back( ViewNode( static_cast<const NodeData&>( *u)));
+            m_nodes.back().m_base = u;
+            nodes[u->getDescriptor()] = &m_nodes.back();
+            numEdges += std::distance( G.beginEdges(u), G.endEdges(u));
+            numInEdges += std::distance( G.beginInEdges(u), G.endInEdges(u));
+        }
+        m_targets.reserve( numEdges);
+        m_sources.reserve( numInEdges);
+        for ( unsigned int i = 0; i < m_nodes.size(); ++i)
+        {
+            u = m_nodes[i].m_base;
+            m_nodes[i].m_targets = m_targets.data() + m_targets.size();
+            m_nodes[i].m_sources = m_sources.data() + m_sources.size();
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                m_targets.push_back( nodes[G.target(e)->getDescriptor()]);
+            }
+            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+            {
+                m_sources.push_back( nodes[G.source(k)->getDescriptor()]);
+            }
+        }
+    }
+
+    GraphType& getBaseGraph()
+    {
+        return G;
+    }
+
+    NodeIterator beginNodes()
+    {
+        return m_nodes.data();
+    }
+
+    NodeIterator endNodes()
+    {
+        return m_nodes.data() + m_nodes.size();
+    }
+
+    EdgeIterator beginEdges( const NodeIterator& u) const
+    {
+        return EdgeIterator( G.beginEdges( u->m_base), u->m_targets);
+    }
+
+    EdgeIterator endEdges( const NodeIterator& u) const
+    {
+        return EdgeIterator( G.endEdges( u->m_base), 0);
+    }
+
+    InEdgeIterator beginInEdges( const NodeIterator& u) const
+    {
+        return InEdgeIterator( G.beginInEdges( u->m_base), u->m_sources);
+    }
+
+    InEdgeIterator endInEdges( const NodeIterator& u) const
+    {
+        return InEdgeIterator( G.endInEdges( u->m_base), 0);
+    }
+
+    NodeIterator target( const EdgeIterator& e) const
+    {
+        return *( e.m_adjacent);
+    }
+
+    NodeIterator source( const InEdgeIterator& k) const
+    {
+        return *( k.m_adjacent);
+    }
+
+    /**
+     * @brief Returns the outgoing edge from u to v, or the end of the edges of u if there is none
+     */
+    EdgeIterator getEdgeIterator( const NodeIterator& u, const NodeIterator& v) const
+    {
+        EdgeIterator e, lastEdge;
+        for( e = beginEdges(u), lastEdge = endEdges(u); e != lastEdge; ++e)
+        {
+            if ( target(e) == v) break;
+        }
+        return e;
+    }
+
+    EdgeIterator getEdgeIterator( const InEdgeIterator& k) const
+    {
+        NodeIterator u = source(k);
+        typename GraphType::EdgeIterator e = G.getEdgeIterator( k.m_edge);
+        return EdgeIterator( e, u->m_targets + std::distance( G.beginEdges( u->m_base), e));
+    }
+
+    InEdgeIterator getInEdgeIterator( const EdgeIterator& e) const
+    {
+        NodeIterator v = target(e);
+        typename GraphType::InEdgeIterator k = G.getInEdgeIterator( e.m_edge);
+        return InEdgeIterator( k, v->m_sources + std::distance( G.beginInEdges( v->m_base), k));
+    }
+
+    NodeDescriptor getNodeDescriptor( const NodeIterator& u) const
+    {
+        return u;
+    }
+
+    NodeIterator getNodeIterator( const NodeDescriptor& descriptor) const
+    {
+        return descriptor;
+    }
+
+    NodeIterator getNodeIterator( const void* descriptor) const
+    {
+        return (NodeDescriptor) descriptor;
+    }
+
+    NodeDescriptor nilNodeDescriptor() const
+    {
+        return 0;
+    }
+
+    SizeType getNumNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    SizeType getNumEdges() const
+    {
+        return m_targets.size();
+    }
+
+    /**
+     * @brief Returns the position of a node in the range [0, numNodes-1], the same as in the base graph
+     */
+    SizeType getRelativePosition( const NodeIterator& u) const
+    {
+        return u - m_nodes.data();
+    }
+
+private:
+    GraphType& G;
+    std::vector<ViewNode> m_nodes;
+    std::vector<ViewNode*> m_targets;
+    std::vector<ViewNode*> m_sources;
+};
+
+#endif // GRAPHVIEW_H
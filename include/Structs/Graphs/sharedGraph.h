@@ -0,0 +1,328 @@
+#ifndef SHAREDGRAPH_H
+#define SHAREDGRAPH_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <string>
+
+/**
+ * @class SharedGraph
+ *
+ * @brief Immutable multicriteria graph stored in a POSIX shared-memory segment
+ *
+ * The segment holds the outgoing and incoming edges of every node in compressed sparse row form, the criteria of the
+ * edges and the coordinates of the nodes. The nodes are indexed by their id and the edges by their position in the
+ * iteration order of the source graph. Every array is addressed by its offset from the start of the segment, so the
+ * segment can be mapped at any address.
+ *
+ * One process creates the segment from a DynamicGraph, any number of processes attach to it read-only and run their
+ * searches with private state (see SharedNamoaStar).
+ */
+class SharedGraph
+{
+public:
+    typedef CriteriaList::WeightType WeightType;
+
+    SharedGraph(): m_base(0), m_size(0), m_header(0)
+    {
+    }
+
+    ~SharedGraph()
+    {
+        detach();
+    }
+
+    /**
+     * @brief Writes a graph to a new segment, replacing any segment with the same name
+     *
+     * @param name The name of the segment, starting with '/'
+     * @param G The graph, whose node ids must increase along its nodes
+     * @return False if the segment could not be created or the ids do not increase
+     */
+    template<class GraphType>
+    static bool create( const std::string& name, GraphType& G)
+    {
+        typedef typename GraphType::NodeIterator NodeIterator;
+        typedef typename GraphType::EdgeIterator EdgeIterator;
+        NodeIterator u, lastNode;
+        EdgeIterator e, lastEdge;
+
+        Header header;
+        memset( &header, 0, sizeof( header));
+        header.magic = MAGIC;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->id + 1 <= header.numNodes) return false;
+            header.numNodes = u->id + 1;
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                header.numCriteria = e->criteriaList.size();
+                ++header.numEdges;
+            }
+        }
+        unsigned long long size = sizeof( Header);
+        header.outOffset = reserve( size, ( header.numNodes + 1) * sizeof( unsigned int));
+        header.targetOffset = reserve( size, header.numEdges * sizeof( unsigned int));
+        header.inOffset = reserve( size, ( header.numNodes + 1) * sizeof( unsigned int));
+        header.inEdgeOffset = reserve( size, header.numEdges * sizeof( unsigned int));
+        header.sourceOffset = reserve( size, header.numEdges * sizeof( unsigned int));
+        header.costOffset = reserve( size, header.numEdges * header.numCriteria * sizeof( WeightType));
+        header.xOffset = reserve( size, header.numNodes * sizeof( unsigned int));
+        header.yOffset = reserve( size, header.numNodes * sizeof( unsigned int));
+        header.size = size;
+
+        shm_unlink( name.c_str());
+        int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if ( fd < 0) return false;
+        if ( ftruncate( fd, size) != 0)
+        {
+            close( fd);
+            shm_unlink( name.c_str());
+            return false;
+        }
+        void* address = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close( fd);
+        if ( address == MAP_FAILED)
+        {
+            shm_unlink( name.c_str());
+            return false;
+        }
+        char* base = static_cast<char*>( address);
+        unsigned int* out = reinterpret_cast<unsigned int*>( base + header.outOffset);
+        unsigned int* target = reinterpret_cast<unsigned int*>( base + header.targetOffset);
+        unsigned int* in = reinterpret_cast<unsigned int*>( base + header.inOffset);
+        unsigned int* inEdge = reinterpret_cast<unsigned int*>( base + header.inEdgeOffset);
+        unsigned int* source = reinterpret_cast<unsigned int*>( base + header.sourceOffset);
+        WeightType* cost = reinterpret_cast<WeightType*>( base + header.costOffset);
+        unsigned int* x = reinterpret_cast<unsigned int*>( base + header.xOffset);
+        unsigned int* y = reinterpret_cast<unsigned int*>( base + header.yOffset);
+
+        // edges in the iteration order of G, grouped by source afterwards
+        std::vector<unsigned int> sources, targets;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            x[u->id] = u->x;
+            y[u->id] = u->y;
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                for ( unsigned int k = 0; k < header.numCriteria; ++k)
+                {
+                    cost[sources.size() * header.numCriteria + k] = e->criteriaList[k];
+                }
+                sources.push_back( u->id);
+                targets.push_back( G.target(e)->id);
+            }
+        }
+        // the nodes come in the order of their ids, so the edges are already sorted by source
+        for ( unsigned int i = 0; i < sources.size(); ++i)
+        {
+            ++out[sources[i] + 1];
+            ++in[targets[i] + 1];
+            target[i] = targets[i];
+            source[i] = sources[i];
+        }
+        for ( unsigned int v = 0; v < header.numNodes; ++v)
+        {
+            out[v + 1] += out[v];
+            in[v + 1] += in[v];
+        }
+        std::vector<unsigned int> next( in, in + header.numNodes);
+        for ( unsigned int i = 0; i < sources.size(); ++i)
+        {
+            inEdge[next[targets[i]]++] = i;
+        }
+        memcpy( base, &header, sizeof( header));
+        munmap( address, size);
+        return true;
+    }
+
+    /**
+     * @brief Removes a segment. The processes attached to it keep their mapping
+     */
+    static void remove( const std::string& name)
+    {
+        shm_unlink( name.c_str());
+    }
+
+    /**
+     * @brief Maps an existing segment read-only
+     *
+     * @return False if the segment does not exist or it does not hold a graph
+     */
+    bool attach( const std::string& name)
+    {
+        detach();
+        int fd = shm_open( name.c_str(), O_RDONLY, 0);
+        if ( fd < 0) return false;
+        struct stat status;
+        if ( ( fstat( fd, &status) != 0) || ( (size_t) status.st_size < sizeof( Header)))
+        {
+            close( fd);
+            return false;
+        }
+        void* address = mmap( 0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close( fd);
+        if ( address == MAP_FAILED) return false;
+        m_base = static_cast<const char*>( address);
+        m_size = status.st_size;
+        m_header = reinterpret_cast<const Header*>( m_base);
+        if ( ( m_header->magic != MAGIC) || ( m_header->size != m_size))
+        {
+            detach();
+            return false;
+        }
+        m_out = array<unsigned int>( m_header->outOffset);
+        m_target = array<unsigned int>( m_header->targetOffset);
+        m_in = array<unsigned int>( m_header->inOffset);
+        m_inEdge = array<unsigned int>( m_header->inEdgeOffset);
+        m_source = array<unsigned int>( m_header->sourceOffset);
+        m_cost = array<WeightType>( m_header->costOffset);
+        m_x = array<unsigned int>( m_header->xOffset);
+        m_y = array<unsigned int>( m_header->yOffset);
+        return true;
+    }
+
+    void detach()
+    {
+        if ( m_base != 0) munmap( const_cast<char*>( m_base), m_size);
+        m_base = 0;
+        m_size = 0;
+        m_header = 0;
+    }
+
+    bool isAttached() const
+    {
+        return m_base != 0;
+    }
+
+    /**
+     * @brief Returns the number of node ids, one more than the largest id
+     */
+    unsigned int getNumNodes() const
+    {
+        return m_header->numNodes;
+    }
+
+    unsigned int getNumEdges() const
+    {
+        return m_header->numEdges;
+    }
+
+    unsigned int getNumCriteria() const
+    {
+        return m_header->numCriteria;
+    }
+
+    /**
+     * @brief The outgoing edges of u are [beginEdges(u), endEdges(u))
+     */
+    unsigned int beginEdges( const unsigned int& u) const
+    {
+        return m_out[u];
+    }
+
+    unsigned int endEdges( const unsigned int& u) const
+    {
+        return m_out[u + 1];
+    }
+
+    /**
+     * @brief The incoming edges of v are getInEdge(i) for i in [beginInEdges(v), endInEdges(v))
+     */
+    unsigned int beginInEdges( const unsigned int& v) const
+    {
+        return m_in[v];
+    }
+
+    unsigned int endInEdges( const unsigned int& v) const
+    {
+        return m_in[v + 1];
+    }
+
+    unsigned int getInEdge( const unsigned int& i) const
+    {
+        return m_inEdge[i];
+    }
+
+    unsigned int getSource( const unsigned int& e) const
+    {
+        return m_source[e];
+    }
+
+    unsigned int getTarget( const unsigned int& e) const
+    {
+        return m_target[e];
+    }
+
+    /**
+     * @brief Returns the criteria of an edge, getNumCriteria() consecutive values
+     */
+    const WeightType* getCost( const unsigned int& e) const
+    {
+        return m_cost + (unsigned long long) e * m_header->numCriteria;
+    }
+
+    /**
+     * @brief Starts loading the first targets and criteria of the outgoing edges of u into the cache
+     */
+    void prefetchEdges( const unsigned int& u) const
+    {
+        __builtin_prefetch( m_target + m_out[u]);
+        __builtin_prefetch( getCost( m_out[u]));
+    }
+
+    unsigned int getX( const unsigned int& u) const
+    {
+        return m_x[u];
+    }
+
+    unsigned int getY( const unsigned int& u) const
+    {
+        return m_y[u];
+    }
+
+private:
+    static const unsigned long long MAGIC = 0x4d43475241504832ULL;  // "MCGRAPH2"
+
+    struct Header
+    {
+        unsigned long long magic;
+        unsigned long long size;
+        unsigned int numNodes, numEdges, numCriteria;
+        unsigned long long outOffset, targetOffset, inOffset, inEdgeOffset, sourceOffset, costOffset, xOffset, yOffset;
+    };
+
+    const char* m_base;
+    size_t m_size;
+    const Header* m_header;
+    const unsigned int *m_out, *m_target, *m_in, *m_inEdge, *m_source, *m_x, *m_y;
+    const WeightType* m_cost;
+
+    /**
+     * @brief Reserves an 8-byte aligned block at the end of the segment
+     *
+     * @return The offset of the block
+     */
+    static unsigned long long reserve( unsigned long long& size, const unsigned long long& bytes)
+    {
+        size = ( size + 7) & ~7ULL;
+        unsigned long long offset = size;
+        size += bytes;
+        return offset;
+    }
+
+    template<typename T>
+    const T* array( const unsigned long long& offset) const
+    {
+        return reinterpret_cast<const T*>( m_base + offset);
+    }
+
+    SharedGraph( const SharedGraph&);
+    SharedGraph& operator=( const SharedGraph&);
+};
+
+#endif // SHAREDGRAPH_H
@@ -0,0 +1,282 @@
+#ifndef BATCHEXECUTOR_H
+#define BATCHEXECUTOR_H
+
+#include <Algorithms/multicriteriaGraph.h>
+#include <Structs/Graphs/graphView.h>
+#include <Utilities/queryLimits.h>
+#include <Utilities/threadPool.h>
+#include <Utilities/timer.h>
+#include <memory>
+#include <mutex>
+
+static unsigned int NUM_WORKERS = 1;    // queries run at the same time by the drivers
+static QueryLimits QUERY_LIMITS;        // limits of every query run by the drivers
+
+/**
+ * @brief Outcome of a query run by a BatchExecutor
+ */
+struct BatchResult
+{
+    BatchResult(): generatedLabels(0), heuristicTime(0), runtime(0), complete(true)
+    {
+    }
+
+    std::vector<Label> solutions;   // G_cl(t) after the query
+    unsigned int generatedLabels;
+    double heuristicTime;           // seconds spent in init
+    double runtime;                 // seconds spent in runQuery
+    bool complete;                  // false if the query was stopped by its limits
+    std::vector<CriteriaList> frontier;     // lower bounds of the missing solutions of a stopped query
+};
+
+/**
+ * @brief Builds the preprocessing of an algorithm, or loads it from its file, before the first query. Overloaded by
+ * the algorithms with preprocessing, the others have nothing to do
+ */
+template<class AlgorithmType>
+void loadOrPreprocess( AlgorithmType& algorithm)
+{
+}
+
+/**
+ * @brief Makes an algorithm use the preprocessing of another one, on a view of the same graph, instead of building its
+ * own. Overloaded by the algorithms with preprocessing
+ */
+template<class AlgorithmType>
+void sharePreprocessing( AlgorithmType& from, AlgorithmType& to)
+{
+}
+
+/**
+ * @brief Changes the criteria of some edges, given by their ids (see Edge::id), and repairs the preprocessing of an
+ * algorithm. Overloaded by the algorithms that can repair their preprocessing, the others leave the graph unchanged
+ *
+ * @return False if the criteria were not changed
+ */
+template<class AlgorithmType>
+bool repairPreprocessing( AlgorithmType& algorithm, const std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+{
+    return false;
+}
+
+/**
+ * @class BatchExecutor
+ *
+ * @brief Runs a list of queries on several worker threads
+ *
+ * The algorithms and heuristic engines keep their search state in the nodes of the graph, so every worker owns a
+ * search context: a view of the graph (see GraphView), with its own copy of the node data, and its own algorithm
+ * object. The edges and their data are shared by all the views. The first worker builds or loads the preprocessing of
+ * the algorithm and the others share it read-only (see loadOrPreprocess and sharePreprocessing). With several workers
+ * the algorithms are built with a single inner thread, since the workers already use the cores. The queries are handed
+ * out dynamically and the results are stored in the order of the input.
+ *
+ * @tparam GraphType The type of the graph to run the queries on
+ * @tparam AlgorithmType The algorithm run on every query, on a GraphView<GraphType>
+ */
+template<class GraphType, class AlgorithmType>
+class BatchExecutor
+{
+public:
+    typedef GraphView<GraphType>                ContextGraph;
+    typedef typename ContextGraph::NodeIterator NodeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+
+    /**
+     * @brief Constructor. The views are built here, so the graph must be complete
+     *
+     * @param graph The graph to run the queries on
+     * @param numCriteria The number of criteria
+     * @param numWorkers The number of queries run at the same time
+     */
+    BatchExecutor( GraphType& graph, unsigned int numCriteria, unsigned int numWorkers):
+                   G(graph), m_numCriteria(numCriteria), m_preprocessed(false), m_pool( numWorkers), m_contexts( m_pool.size())
+    {
+        unsigned int numThreads = NUM_THREADS;
+        if ( m_contexts.size() > 1) NUM_THREADS = 1;
+        for ( unsigned int i = 0; i < m_contexts.size(); ++i)
+        {
+            Context& context = m_contexts[i];
+            context.timestamp = 0;
+            context.graph.reset( new ContextGraph( G));
+            NodeIterator u,lastNode;
+            for( u = context.graph->beginNodes(), lastNode = context.graph->endNodes(); u != lastNode; ++u)
+            {
+                if ( u->id >= context.nodes.size()) context.nodes.resize( u->id + 1);
+                context.nodes[u->id] = u;
+            }
+            context.algorithm.reset( new AlgorithmType( *context.graph, numCriteria, &context.timestamp));
+        }
+        NUM_THREADS = numThreads;
+    }
+
+    unsigned int getNumWorkers() const
+    {
+        return m_contexts.size();
+    }
+
+    /**
+     * @brief Calls a function on the algorithm of every worker, e.g. to set its parameters
+     */
+    void forEachAlgorithm( const std::function<void( AlgorithmType&)>& setup)
+    {
+        for ( unsigned int i = 0; i < m_contexts.size(); ++i)
+        {
+            setup( *m_contexts[i].algorithm);
+        }
+    }
+
+    /**
+     * @brief Sets the limits of every query. Only the algorithms based on NamoaStar2 stop a query early (see
+     * NamoaStar2::setQueryLimits), and their results tell whether it completed
+     *
+     * @return False if the algorithm ignores the limits
+     */
+    bool setQueryLimits( const QueryLimits& limits)
+    {
+        bool applied = false;
+        for ( unsigned int i = 0; i < m_contexts.size(); ++i)
+        {
+            applied = limitQueries( *m_contexts[i].algorithm, limits, 0);
+        }
+        return applied;
+    }
+
+    /**
+     * @brief Builds or loads the preprocessing of the algorithm once, on the first worker, and shares it with the
+     * others. Called by the first run or serve, or before to keep the preprocessing out of the first queries
+     */
+    void preprocess()
+    {
+        if ( m_preprocessed) return;
+        loadOrPreprocess( *m_contexts[0].algorithm);
+        for ( unsigned int i = 1; i < m_contexts.size(); ++i)
+        {
+            sharePreprocessing( *m_contexts[0].algorithm, *m_contexts[i].algorithm);
+        }
+        m_preprocessed = true;
+    }
+
+    /**
+     * @brief Changes the criteria of some edges of the graph and repairs the preprocessing, which is built first if
+     * needed (see repairPreprocessing). No query may be running
+     *
+     * @return False if the algorithm cannot repair its preprocessing, then the graph is left unchanged
+     */
+    bool updateWeights( const std::vector< std::pair<unsigned int, CriteriaList> >& changes)
+    {
+        preprocess();
+        return repairPreprocessing( *m_contexts[0].algorithm, changes);
+    }
+
+    /**
+     * @brief Runs the queries, given as pairs of positions in ids, and stores their results in the same order
+     */
+    void run( const std::vector< std::pair<unsigned int,unsigned int> >& queries,
+              const std::vector<NodeDescriptor>& ids, std::vector<BatchResult>& results)
+    {
+        preprocess();
+        results.assign( queries.size(), BatchResult());
+        m_pool.parallelFor( queries.size(), [&]( unsigned int i, unsigned int worker)
+        {
+            runQuery( worker, queries[i], ids, results[i]);
+        });
+    }
+
+    /**
+     * @brief Runs the queries given by next until it returns false, passing every result to report as soon as its
+     * query is done, with the position of the query in the stream. Both functions are called by one worker at a time,
+     * but a worker waiting in next does not delay the reports of the others
+     */
+    void serve( const std::function<bool( std::pair<unsigned int,unsigned int>&)>& next, const std::vector<NodeDescriptor>& ids,
+                const std::function<void( unsigned int, const std::pair<unsigned int,unsigned int>&, const BatchResult&)>& report)
+    {
+        preprocess();
+        std::mutex input, output;
+        unsigned int count = 0;
+        m_pool.run( [&]( unsigned int worker)
+        {
+            while ( true)
+            {
+                std::pair<unsigned int,unsigned int> query;
+                unsigned int position;
+                {
+                    std::unique_lock<std::mutex> lock( input);
+                    if ( !( next( query))) return;
+                    position = count++;
+                }
+                BatchResult result;
+                runQuery( worker, query, ids, result);
+                std::unique_lock<std::mutex> lock( output);
+                report( position, query, result);
+            }
+        });
+    }
+
+private:
+    struct Context
+    {
+        std::unique_ptr<ContextGraph> graph;
+        std::vector<NodeIterator> nodes;        // [node id]
+        std::unique_ptr<AlgorithmType> algorithm;
+        unsigned int timestamp;
+    };
+
+    GraphType& G;
+    unsigned int m_numCriteria;
+    bool m_preprocessed;
+    ThreadPool m_pool;
+    std::vector<Context> m_contexts;
+
+    template<class Algorithm>
+    static auto limitQueries( Algorithm& algorithm, const QueryLimits& limits, int) -> decltype( algorithm.setQueryLimits( limits), true)
+    {
+        algorithm.setQueryLimits( limits);
+        return true;
+    }
+
+    template<class Algorithm>
+    static bool limitQueries( Algorithm&, const QueryLimits&, long)
+    {
+        return false;
+    }
+
+    template<class Algorithm>
+    static auto getCompleteness( const Algorithm& algorithm, BatchResult& result, int) -> decltype( algorithm.getFrontier( result.frontier))
+    {
+        result.complete = algorithm.isComplete();
+        algorithm.getFrontier( result.frontier);
+    }
+
+    template<class Algorithm>
+    static void getCompleteness( const Algorithm&, BatchResult&, long)
+    {
+    }
+
+    void runQuery( const unsigned int& worker, const std::pair<unsigned int,unsigned int>& query,
+                   const std::vector<NodeDescriptor>& ids, BatchResult& result)
+    {
+        Context& context = m_contexts[worker];
+        NodeIterator s = context.nodes[G.getNodeIterator( ids[query.first])->id];
+        NodeIterator t = context.nodes[G.getNodeIterator( ids[query.second])->id];
+        NodeIterator u,lastNode;
+        for( u = context.graph->beginNodes(), lastNode = context.graph->endNodes(); u != lastNode; ++u)
+        {
+            u->g_op.clear();
+            u->g_cl.clear();
+            u->labels.clear();
+        }
+        Timer timer;
+        timer.start();
+        context.algorithm->init( s, t, m_numCriteria);
+        result.heuristicTime = timer.getElapsedTime();
+        timer.start();
+        context.algorithm->runQuery( s, t);
+        result.runtime = timer.getElapsedTime();
+        result.solutions = t->g_cl;
+        result.generatedLabels = context.algorithm->getGeneratedLabels();
+        getCompleteness( *context.algorithm, result, 0);
+    }
+};
+
+#endif // BATCHEXECUTOR_H
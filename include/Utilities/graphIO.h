@@ -96,17 +96,20 @@ public:
             for( u = G.beginNodes(), end = G.endNodes(); u != end; ++u)
             {
                 GraphReader<GraphType>::m_ids.push_back( G.getNodeDescriptor(u));
-                //u->x = x;
-                //u->y = y;
+                // the node at (x,y) is stored at position x*GRIDDIMSIZE+y, see coord2Desc
+                u->x = x;
+                u->y = y;
                 u->id = cont;
 
-                /*
                 if (y + 1 == GRIDDIMSIZE)
                 {
                     y = 0;
                     ++x;
                 }
-                */
+                else
+                {
+                    ++y;
+                }
                 ++cont;
                 ++node_progress;
             }
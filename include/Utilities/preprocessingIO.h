@@ -0,0 +1,88 @@
+#ifndef PREPROCESSINGIO_H
+#define PREPROCESSINGIO_H
+
+#include <fstream>
+#include <vector>
+
+//------------------------------ FILES OF PREPROCESSING DATA ------------------------------//
+
+/**
+ * @brief Numbers the edges of a graph in the order of its nodes and of their outgoing edges, so the data of an edge
+ * written to a file can be found again by its id
+ *
+ * @return The number of edges
+ */
+template<typename GraphType>
+unsigned int numberEdges( GraphType& G)
+{
+    typename GraphType::NodeIterator u, lastNode;
+    typename GraphType::EdgeIterator e, lastEdge;
+    unsigned int numEdges = 0;
+    for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+        {
+            e->id = numEdges++;
+        }
+    }
+    return numEdges;
+}
+
+/**
+ * @brief Hash of the topology, the coordinates and the costs of a graph, so data written for another graph, or for
+ * the same graph with other costs, is not loaded
+ */
+template<typename GraphType>
+unsigned long long getGraphChecksum( GraphType& G, const unsigned int& numCriteria)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    typename GraphType::NodeIterator u, lastNode;
+    typename GraphType::EdgeIterator e, lastEdge;
+    for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+        {
+            hash = ( hash ^ G.getRelativePosition( G.target(e))) * 1099511628211ULL;
+            for ( unsigned int j = 0; j < numCriteria; ++j)
+            {
+                hash = ( hash ^ e->criteriaList[j]) * 1099511628211ULL;
+            }
+        }
+        hash = ( hash ^ u->x ^ ( (unsigned long long) u->y << 32)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+void writeValue( std::ofstream& out, const T& value)
+{
+    out.write( reinterpret_cast<const char*>( &value), sizeof( T));
+}
+
+template <typename T>
+void readValue( std::ifstream& in, T& value)
+{
+    in.read( reinterpret_cast<char*>( &value), sizeof( T));
+}
+
+/**
+ * @brief Writes the size of a vector of plain values followed by its values
+ */
+template <typename T>
+void writeList( std::ofstream& out, const std::vector<T>& list)
+{
+    writeValue( out, (unsigned int) list.size());
+    if ( !list.empty()) out.write( reinterpret_cast<const char*>( &list[0]), list.size() * sizeof( T));
+}
+
+template <typename T>
+void readList( std::ifstream& in, std::vector<T>& list)
+{
+    unsigned int size = 0;
+    readValue( in, size);
+    if ( !in.good()) return;
+    list.resize( size);
+    if ( size) in.read( reinterpret_cast<char*>( &list[0]), size * sizeof( T));
+}
+
+#endif // PREPROCESSINGIO_H
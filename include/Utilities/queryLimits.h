@@ -0,0 +1,63 @@
+#ifndef QUERYLIMITS_H
+#define QUERYLIMITS_H
+
+#include <Utilities/timer.h>
+#include <atomic>
+
+/**
+ * @brief Limits of a single query. A zero (or null) field is not checked
+ */
+struct QueryLimits
+{
+    QueryLimits(): maxTime(0), maxLabels(0), maxStoredLabels(0), cancel(0)
+    {
+    }
+
+    double maxTime;                      // wall time in seconds
+    unsigned int maxLabels;              // labels expanded
+    unsigned int maxStoredLabels;        // labels stored in G_op and G_cl
+    const std::atomic<bool>* cancel;     // set to true by another thread to stop the query
+};
+
+/**
+ * @class QueryGuard
+ *
+ * @brief Checks the limits of a query from its main loop. The clock and the cancellation token are only read every
+ * few calls, so the check is cheap enough to be done once per label
+ */
+class QueryGuard
+{
+public:
+    QueryGuard(): m_calls(0)
+    {
+    }
+
+    void start( const QueryLimits& limits)
+    {
+        m_limits = limits;
+        m_calls = 0;
+        m_timer.start();
+    }
+
+    bool isExceeded( const unsigned int& labels, const unsigned int& storedLabels)
+    {
+        if ( ( m_limits.maxLabels && labels >= m_limits.maxLabels) ||
+             ( m_limits.maxStoredLabels && storedLabels >= m_limits.maxStoredLabels))
+        {
+            return true;
+        }
+        if ( ( ++m_calls & 255) != 0)
+        {
+            return false;
+        }
+        return ( m_limits.cancel && m_limits.cancel->load( std::memory_order_relaxed)) ||
+               ( m_limits.maxTime > 0 && m_timer.getElapsedTime() >= m_limits.maxTime);
+    }
+
+private:
+    QueryLimits m_limits;
+    Timer m_timer;
+    unsigned int m_calls;
+};
+
+#endif // QUERYLIMITS_H
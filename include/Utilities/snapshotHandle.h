@@ -0,0 +1,90 @@
+#ifndef SNAPSHOTHANDLE_H
+#define SNAPSHOTHANDLE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class SnapshotHandle
+ *
+ * @brief Versioned handle to an immutable snapshot (e.g. a graph and its preprocessing) that can be replaced while
+ * it is read
+ *
+ * A reader takes the current snapshot with acquire and keeps it for the whole query, so a query always runs on one
+ * version. A new snapshot is built in the background by reload and swapped in atomically; the old one is destroyed
+ * when the last query holding it ends.
+ *
+ * @tparam SnapshotType The type of the snapshot
+ */
+template<class SnapshotType>
+class SnapshotHandle
+{
+public:
+    typedef std::shared_ptr<const SnapshotType> SnapshotPointer;
+
+    SnapshotHandle(): m_version(0)
+    {
+    }
+
+    ~SnapshotHandle()
+    {
+        wait();
+    }
+
+    SnapshotPointer acquire() const
+    {
+        return std::atomic_load( &m_current);
+    }
+
+    /**
+     * @brief Replaces the current snapshot
+     *
+     * @return The version of the new snapshot, starting at 1
+     */
+    unsigned int publish( const SnapshotPointer& snapshot)
+    {
+        std::atomic_store( &m_current, snapshot);
+        return ++m_version;
+    }
+
+    unsigned int getVersion() const
+    {
+        return m_version;
+    }
+
+    /**
+     * @brief Builds a snapshot on a background thread and publishes it, unless the build returns null. A reload
+     * requested while another one is running starts when that one ends
+     */
+    void reload( const std::function<SnapshotPointer()>& build)
+    {
+        std::unique_lock<std::mutex> lock( m_mutex);
+        std::thread previous( std::move( m_loader));
+        m_loader = std::thread( [this, build]( std::thread previous)
+        {
+            if ( previous.joinable()) previous.join();
+            SnapshotPointer snapshot = build();
+            if ( snapshot) publish( snapshot);
+        }, std::move( previous));
+    }
+
+    /**
+     * @brief Waits for the reloads requested so far
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock( m_mutex);
+        if ( m_loader.joinable()) m_loader.join();
+    }
+
+private:
+    SnapshotPointer m_current;
+    std::atomic<unsigned int> m_version;
+    std::mutex m_mutex;
+    std::thread m_loader;
+};
+
+#endif // SNAPSHOTHANDLE_H
@@ -0,0 +1,115 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+
+static unsigned int NUM_THREADS = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+/**
+ * @class ThreadPool
+ *
+ * @brief Fixed set of worker threads running the same task in lock step
+ *
+ * Every call to run executes a task once per thread, passing the index of the thread, and returns when all of them
+ * are done. The calling thread takes index 0, so a pool of one thread runs everything sequentially.
+ */
+class ThreadPool
+{
+public:
+    ThreadPool( const unsigned int& numThreads = NUM_THREADS): m_task(0), m_generation(0), m_running(0), m_stop(false)
+    {
+        for ( unsigned int i = 1; i < numThreads; ++i)
+        {
+            m_workers.push_back( std::thread( &ThreadPool::work, this, i));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for ( unsigned int i = 0; i < m_workers.size(); ++i)
+        {
+            m_workers[i].join();
+        }
+    }
+
+    unsigned int size() const
+    {
+        return m_workers.size() + 1;
+    }
+
+    /**
+     * @brief Runs task(threadIndex) on every thread of the pool and waits for all of them
+     */
+    void run( const std::function<void(unsigned int)>& task)
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex);
+            m_task = &task;
+            m_running = m_workers.size();
+            ++m_generation;
+        }
+        m_start.notify_all();
+        task( 0);
+        std::unique_lock<std::mutex> lock( m_mutex);
+        m_done.wait( lock, [this] { return m_running == 0; });
+        m_task = 0;
+    }
+
+    /**
+     * @brief Runs body(i, threadIndex) for every i in [0,n), handing out the indices dynamically
+     */
+    void parallelFor( const unsigned int& n, const std::function<void(unsigned int, unsigned int)>& body)
+    {
+        std::atomic<unsigned int> next( 0);
+        run( [&]( unsigned int threadIndex)
+        {
+            for ( unsigned int i = next++; i < n; i = next++)
+            {
+                body( i, threadIndex);
+            }
+        });
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start, m_done;
+    const std::function<void(unsigned int)>* m_task;
+    unsigned int m_generation;
+    unsigned int m_running;
+    bool m_stop;
+
+    void work( const unsigned int index)
+    {
+        unsigned int generation = 0;
+        while ( true)
+        {
+            const std::function<void(unsigned int)>* task;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex);
+                m_start.wait( lock, [&] { return m_stop || m_generation != generation; });
+                if ( m_stop) return;
+                generation = m_generation;
+                task = m_task;
+            }
+            (*task)( index);
+            {
+                std::unique_lock<std::mutex> lock( m_mutex);
+                --m_running;
+            }
+            m_done.notify_one();
+        }
+    }
+};
+
+#endif // THREADPOOL_H